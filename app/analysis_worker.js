@@ -0,0 +1,23 @@
+// Worker thread for the analysis pool: runs one backend, one job at a time.
+//
+// The image arrives as a transferred ArrayBuffer, so it is owned by this thread
+// and no copy was made on the way in. With returnImage it is transferred back
+// with the reply, after the backend is done with it.
+
+const { parentPort, workerData } = require('worker_threads');
+const { loadBackend } = require('./worker_pool');
+
+const backend = loadBackend(workerData.backend);
+
+parentPort.on('message', ({ id, image, length, meta }) => {
+    const reply = message => workerData.returnImage
+        ? parentPort.postMessage({ ...message, image, length }, [image])
+        : parentPort.postMessage(message);
+
+    Promise.resolve()
+        .then(() => backend.analyze(new Uint8Array(image, 0, length), meta))
+        .then(
+            result => reply({ id, result }),
+            error => reply({ id, error: error.message || String(error) })
+        );
+});
@@ -0,0 +1,139 @@
+// Mock analysis backend: random faces, objects and context after a simulated delay.
+//
+// Runs inside an analysis worker. With MOCK_CPU_BOUND=true the delay is spent
+// spinning instead of sleeping, so it occupies its worker the way a real model
+// would and throughput scales with ANALYSIS_WORKERS.
+
+// Simulated analysis delay, widen it to exercise the firmware's frame deadlines
+const MOCK_DELAY_MIN_MS = Number(process.env.MOCK_DELAY_MIN_MS || 200);
+const MOCK_DELAY_MAX_MS = Number(process.env.MOCK_DELAY_MAX_MS || 1200);
+const MOCK_SLOW_RATE = Number(process.env.MOCK_SLOW_RATE || 0);         // Fraction of very slow responses
+const MOCK_SLOW_DELAY_MS = Number(process.env.MOCK_SLOW_DELAY_MS || 15000);
+const MOCK_CPU_BOUND = process.env.MOCK_CPU_BOUND === 'true';
+
+// Mock data for responses
+const mockFaces = [
+    { name: "Alice", confidence: 0.95 },
+    { name: "Bob", confidence: 0.87 },
+    { name: "Charlie", confidence: 0.92 },
+    { name: "Diana", confidence: 0.89 }
+];
+
+const mockObjects = [
+    { name: "coffee cup", confidence: 0.85 },
+    { name: "laptop", confidence: 0.78 },
+    { name: "phone", confidence: 0.92 },
+    { name: "book", confidence: 0.76 },
+    { name: "water bottle", confidence: 0.83 },
+    { name: "pen", confidence: 0.71 },
+    { name: "chair", confidence: 0.89 },
+    { name: "table", confidence: 0.94 }
+];
+
+const mockContexts = [
+    "You're in an office environment",
+    "Looks like a coffee break",
+    "Study session in progress",
+    "Meeting room setting",
+    "Working from home setup",
+    "Outdoor environment detected",
+    "Kitchen area identified",
+    "Living room space"
+];
+
+// Helper function to get random items from array
+function getRandomItems(array, count) {
+    const shuffled = [...array].sort(() => 0.5 - Math.random());
+    return shuffled.slice(0, count);
+}
+
+// Helper function to generate a bounding box normalized to the frame (0.0 - 1.0)
+function getRandomBox() {
+    const w = Math.random() * 0.4 + 0.15;
+    const h = Math.random() * 0.4 + 0.15;
+    const round = (v) => Math.round(v * 1000) / 1000;
+    return {
+        x: round(Math.random() * (1 - w)),
+        y: round(Math.random() * (1 - h)),
+        w: round(w),
+        h: round(h)
+    };
+}
+
+// Helper function to attach a bounding box to each detection
+function withBoxes(items) {
+    return items.map(item => ({ ...item, box: getRandomBox() }));
+}
+
+// Helper function to pick the simulated processing delay for one request
+function getMockDelay() {
+    if (Math.random() < MOCK_SLOW_RATE) {
+        return MOCK_SLOW_DELAY_MS;
+    }
+    return Math.random() * (MOCK_DELAY_MAX_MS - MOCK_DELAY_MIN_MS) + MOCK_DELAY_MIN_MS;
+}
+
+// Helper function to spend the delay, either asleep or holding the worker's CPU
+function simulateWork(ms) {
+    if (MOCK_CPU_BOUND) {
+        const until = Date.now() + ms;
+        while (Date.now() < until) {
+            // Busy wait, stands in for model inference
+        }
+        return Promise.resolve();
+    }
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+function describe() {
+    return `mock, ${MOCK_DELAY_MIN_MS}-${MOCK_DELAY_MAX_MS}ms ${MOCK_CPU_BOUND ? 'CPU-bound' : 'sleeping'}, ` +
+        `${MOCK_SLOW_RATE * 100}% slow (${MOCK_SLOW_DELAY_MS}ms)`;
+}
+
+// Resolves with a random mock response, the image bytes are not looked at
+async function analyze(image, meta) {
+    const delay = getMockDelay();
+    await simulateWork(delay);
+
+    // Generate random mock response
+    const shouldDetectFaces = Math.random() > 0.3; // 70% chance of faces
+    const shouldDetectObjects = Math.random() > 0.2; // 80% chance of objects
+    const shouldHaveUnknown = Math.random() > 0.7; // 30% chance of unknown faces
+
+    const response = {
+        status: 'success',
+        timestamp: Date.now(),
+        device_id: meta.device_id,
+        processing_time: Math.round(delay),
+        recognized_faces: [],
+        unknown_faces: 0,
+        objects: [],
+        context: null
+    };
+
+    // Add recognized faces
+    if (shouldDetectFaces) {
+        const numFaces = Math.floor(Math.random() * 3) + 1; // 1-3 faces
+        response.recognized_faces = withBoxes(getRandomItems(mockFaces, numFaces));
+    }
+
+    // Add unknown faces
+    if (shouldHaveUnknown) {
+        response.unknown_faces = Math.floor(Math.random() * 2) + 1; // 1-2 unknown
+    }
+
+    // Add objects
+    if (shouldDetectObjects) {
+        const numObjects = Math.floor(Math.random() * 4) + 1; // 1-4 objects
+        response.objects = withBoxes(getRandomItems(mockObjects, numObjects));
+    }
+
+    // Add context
+    if (Math.random() > 0.4) { // 60% chance of context
+        response.context = mockContexts[Math.floor(Math.random() * mockContexts.length)];
+    }
+
+    return response;
+}
+
+module.exports = { describe, analyze };
@@ -0,0 +1,17 @@
+// Hash "backend" for the cache's hash pool: decodes the JPEG and returns its dHash.
+//
+// The pure-JS JPEG decode is the expensive part of a cache lookup, running it in a
+// worker keeps it off the event loop. Resolves with the hash as a BigInt, or null
+// when the frame can't be decoded (it is then analyzed without a cache lookup).
+
+const { hashJpeg } = require('../phash_cache');
+
+function describe() {
+    return 'dHash over a jpeg-js decode';
+}
+
+async function analyze(image) {
+    return hashJpeg(image);
+}
+
+module.exports = { describe, analyze };
@@ -0,0 +1,76 @@
+// Load test for FairScheduler: one device floods /analyze while two others send at a
+// steady rate, all against the same fixed-cost analysis. Reports each device's share of
+// the analysis time, queue wait and rejections, once with equal weights and once with
+// the weights given in DEVICE_WEIGHTS (default: the steady devices at 2).
+//
+//   node bench/fairness.js [duration_ms]
+//
+// Per-device rate limits are lifted so the fair queue, not the token bucket, decides who
+// runs. SERVICE_MS, CONCURRENCY, QUEUE_LIMIT and DEVICE_MAX_IN_FLIGHT tune the setup.
+
+const { FairScheduler, parseWeights } = require('../scheduler');
+
+const DURATION_MS = Number(process.argv[2] || 3000);
+const SERVICE_MS = Number(process.env.SERVICE_MS || 50);
+const CONCURRENCY = Number(process.env.CONCURRENCY || 2);
+const QUEUE_LIMIT = Number(process.env.QUEUE_LIMIT || 8);
+const MAX_IN_FLIGHT = Number(process.env.DEVICE_MAX_IN_FLIGHT || 3);
+
+// Interval between submissions per device
+const DEVICES = [
+    { id: 'flood', intervalMs: 2 },
+    { id: 'steady-a', intervalMs: 40 },
+    { id: 'steady-b', intervalMs: 40 }
+];
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+async function runDevice(scheduler, device, stopAt, served) {
+    const pending = [];
+    while (Date.now() < stopAt) {
+        const job = scheduler.submit(device.id, () => sleep(SERVICE_MS));
+        if (job.accepted) {
+            pending.push(job.promise.then(() => { served[device.id]++; }));
+        }
+        await sleep(device.intervalMs);
+    }
+    await Promise.all(pending);
+}
+
+async function runScenario(label, weights) {
+    const scheduler = new FairScheduler({
+        concurrency: CONCURRENCY,
+        maxQueued: QUEUE_LIMIT,
+        ratePerSec: 1e6,
+        burst: 1e6,
+        maxInFlightPerDevice: MAX_IN_FLIGHT,
+        weights
+    });
+    const served = Object.fromEntries(DEVICES.map(device => [device.id, 0]));
+    const stopAt = Date.now() + DURATION_MS;
+
+    await Promise.all(DEVICES.map(device => runDevice(scheduler, device, stopAt, served)));
+    clearInterval(scheduler.sweepTimer);
+
+    const metrics = scheduler.getMetrics();
+    const total = Object.values(served).reduce((sum, count) => sum + count, 0);
+    console.log(`\n${label}: ${total} jobs served in ${DURATION_MS} ms`);
+    console.log('device      weight  served  share  wait avg/max ms  rejected');
+    for (const device of DEVICES) {
+        const stats = metrics.devices[device.id];
+        console.log(`${device.id.padEnd(10)}  ${String(stats.weight).padStart(6)}  ${String(served[device.id]).padStart(6)}  ` +
+                    `${(100 * served[device.id] / total).toFixed(0).padStart(4)}%  ` +
+                    `${`${stats.queue_wait.avg_ms}/${stats.queue_wait.max_ms}`.padStart(15)}  ${String(stats.rejected).padStart(8)}`);
+    }
+}
+
+async function main() {
+    console.log(`Service ${SERVICE_MS} ms, concurrency ${CONCURRENCY}, queue limit ${QUEUE_LIMIT}, ` +
+                `in-flight cap ${MAX_IN_FLIGHT} per device`);
+    await runScenario('Equal weights', {});
+    const weights = process.env.DEVICE_WEIGHTS ?
+        parseWeights(process.env.DEVICE_WEIGHTS) : { 'steady-a': 2, 'steady-b': 2 };
+    await runScenario(`Weighted ${JSON.stringify(weights)}`, weights);
+}
+
+main();
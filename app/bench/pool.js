@@ -0,0 +1,113 @@
+// Throughput of the worker pools at 1, 2 and 4 workers.
+//
+//   node bench/pool.js [jobs]
+//
+// The analysis pool runs the mock backend CPU-bound (MOCK_DELAY_MS per job, default
+// 100). The mock spins until a wall-clock deadline, so this shows the pool keeping
+// every worker busy rather than how a real model shares cores. The hash pool decodes
+// and hashes the JPEGs in bench/frames, the work the result cache does per frame, and
+// is compared with hashing on the main thread by how long the event loop stalls.
+// Both hash parts are skipped when the frames can't be decoded here.
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { monitorEventLoopDelay } = require('perf_hooks');
+
+const JOBS = Number(process.argv[2] || 32);
+const MOCK_DELAY_MS = process.env.MOCK_DELAY_MS || '100';
+const SIZES = [1, 2, 4];
+const FRAMES_DIR = path.join(__dirname, 'frames');
+
+// Workers copy the environment when they start, so the mock is configured before any exist
+Object.assign(process.env, {
+    MOCK_CPU_BOUND: 'true',
+    MOCK_DELAY_MIN_MS: MOCK_DELAY_MS,
+    MOCK_DELAY_MAX_MS: MOCK_DELAY_MS,
+    MOCK_SLOW_RATE: '0'
+});
+
+const { WorkerPool, decodeImage } = require('../worker_pool');
+const { hashJpeg } = require('../phash_cache');
+
+function loadFrames() {
+    return fs.readdirSync(FRAMES_DIR)
+        .filter(name => name.endsWith('.jpg'))
+        .sort()
+        .map(name => fs.readFileSync(path.join(FRAMES_DIR, name)).toString('base64'));
+}
+
+// Submits all jobs at once and waits for them, returns the wall time in ms
+async function runJobs(pool, images) {
+    const start = process.hrtime.bigint();
+    await Promise.all(images.map((base64, i) => {
+        const job = pool.submit(decodeImage(base64), { device_id: `bench-${i}` });
+        if (!job.accepted) {
+            throw new Error('Pool refused a job, maxQueue is too small');
+        }
+        return job.promise;
+    }));
+    return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+async function measure(label, backend, images, returnImage) {
+    console.log(`\n${label}: ${images.length} jobs`);
+    console.log('workers  wall ms  jobs/s  speedup');
+    let baseline = null;
+    for (const size of SIZES) {
+        const pool = new WorkerPool({ size, maxQueue: images.length, backend, returnImage });
+        // One job per worker first, so thread start-up and module loading aren't timed
+        await runJobs(pool, images.slice(0, size));
+        const ms = await runJobs(pool, images);
+        await pool.close();
+
+        baseline = baseline || ms;
+        console.log(`${String(size).padStart(7)}  ${ms.toFixed(0).padStart(7)}  ` +
+                    `${(images.length / ms * 1000).toFixed(1).padStart(6)}  ${(baseline / ms).toFixed(2).padStart(6)}x`);
+    }
+}
+
+// Longest event loop stall while all images are hashed, inline or through a hash pool
+async function eventLoopStall(images, pool) {
+    const histogram = monitorEventLoopDelay({ resolution: 1 });
+    histogram.enable();
+    if (pool) {
+        await runJobs(pool, images);
+    } else {
+        for (const base64 of images) {
+            hashJpeg(Buffer.from(base64, 'base64'));
+            await new Promise(resolve => setImmediate(resolve));
+        }
+    }
+    histogram.disable();
+    return histogram.max / 1e6;
+}
+
+async function main() {
+    const frames = loadFrames();
+    console.log(`${os.cpus().length} CPUs`);
+
+    const analysisImages = Array.from({ length: JOBS }, (_, i) => frames[i % frames.length]);
+    await measure(`Analysis pool, mock backend CPU-bound ${MOCK_DELAY_MS} ms/job`, 'mock', analysisImages, false);
+
+    if (hashJpeg(Buffer.from(frames[0], 'base64')) === null) {
+        console.log('\nHash pool skipped: bench/frames do not decode with this jpeg-js');
+        return;
+    }
+    // Hashing is a few ms per frame, more jobs keep the timing above the message overhead
+    const hashImages = Array.from({ length: JOBS * 8 }, (_, i) => frames[i % frames.length]);
+    await measure('Hash pool, dHash of bench/frames', 'phash', hashImages, true);
+
+    // Inline, a request's decode blocks every other request for its whole duration
+    const pool = new WorkerPool({ size: 1, maxQueue: hashImages.length, backend: 'phash', returnImage: true });
+    await runJobs(pool, hashImages.slice(0, 1));
+    const inlineMs = await eventLoopStall(hashImages, null);
+    const pooledMs = await eventLoopStall(hashImages, pool);
+    await pool.close();
+    console.log(`\nLongest event loop stall: ${inlineMs.toFixed(1)} ms hashing inline, ${pooledMs.toFixed(1)} ms through the hash pool`);
+}
+
+main().catch(error => {
+    console.error(error);
+    process.exit(1);
+});
@@ -0,0 +1,79 @@
+// Replays a recorded frame sequence through the perceptual-hash result cache and
+// reports how many analyses it would have saved. Frames are the JPEGs in the given
+// directory in name order, one per FRAME_INTERVAL_MS of simulated time; every miss
+// costs SERVICE_MS of analysis. The bundled frames/ are a short 160x120 sequence: a
+// still scene with sensor noise and jitter, a person walking in, then a scene cut.
+// Frames saved by the server with SAVE_IMAGES=true replay the same way:
+//
+//   node bench/replay.js [frames_dir]
+//   node bench/replay.js uploads
+
+const fs = require('fs');
+const path = require('path');
+const { ResultCache, hashJpeg, hammingDistance } = require('../phash_cache');
+
+const FRAMES_DIR = path.resolve(process.argv[2] || path.join(__dirname, 'frames'));
+const FRAME_INTERVAL_MS = Number(process.env.FRAME_INTERVAL_MS || 1000);
+const SERVICE_MS = Number(process.env.SERVICE_MS || 800);
+const MAX_AGE_MS = Number(process.env.CACHE_MAX_AGE_MS || 10000);
+const DEFAULT_DISTANCE = Number(process.env.CACHE_MAX_DISTANCE || 6);
+const DISTANCES = [0, 2, 4, DEFAULT_DISTANCE, 8, 12].filter((d, i, all) => all.indexOf(d) === i).sort((a, b) => a - b);
+
+function loadFrames() {
+    const names = fs.readdirSync(FRAMES_DIR).filter(name => /\.jpe?g$/i.test(name)).sort();
+    return names.map(name => {
+        const buffer = fs.readFileSync(path.join(FRAMES_DIR, name));
+        const start = process.hrtime.bigint();
+        const hash = hashJpeg(buffer);
+        const hashMs = Number(process.hrtime.bigint() - start) / 1e6;
+        return { name, bytes: buffer.length, hash, hashMs };
+    });
+}
+
+// Runs the sequence through a fresh cache, returns its metrics and which frames hit
+function replay(frames, maxDistance) {
+    let now = 0;
+    const cache = new ResultCache({ maxDistance, maxAgeMs: MAX_AGE_MS, now: () => now });
+    const hits = frames.map(frame => {
+        const cached = cache.lookup('replay', frame.hash);
+        if (!cached) {
+            cache.store('replay', frame.hash, { frame: frame.name }, SERVICE_MS);
+        }
+        now += FRAME_INTERVAL_MS;
+        return cached ? cached.frame : null;
+    });
+    return { metrics: cache.getMetrics(), hits };
+}
+
+function main() {
+    const frames = loadFrames();
+    const usable = frames.filter(frame => frame.hash !== null);
+    if (usable.length === 0) {
+        console.error(`No decodable JPEGs in ${FRAMES_DIR}`);
+        process.exit(1);
+    }
+
+    const hashMs = usable.reduce((sum, frame) => sum + frame.hashMs, 0) / usable.length;
+    console.log(`${usable.length} frames from ${FRAMES_DIR} (${frames.length - usable.length} undecodable), ` +
+                `decode + hash ${hashMs.toFixed(2)} ms/frame`);
+    console.log(`Simulated ${FRAME_INTERVAL_MS} ms between frames, ${SERVICE_MS} ms per analysis, ` +
+                `entries expire after ${MAX_AGE_MS} ms\n`);
+
+    const { hits } = replay(usable, DEFAULT_DISTANCE);
+    console.log(`Frame-by-frame at max distance ${DEFAULT_DISTANCE}:`);
+    usable.forEach((frame, i) => {
+        const step = i > 0 ? hammingDistance(frame.hash, usable[i - 1].hash) : '-';
+        const outcome = hits[i] ? `reuses ${hits[i]}` : 'analyzed';
+        console.log(`  ${frame.name.padEnd(24)} ${String(frame.bytes).padStart(6)} B  ` +
+                    `${String(step).padStart(2)} bits from previous  ${outcome}`);
+    });
+
+    console.log('\nmax distance  hit rate  analyses  latency saved');
+    for (const maxDistance of DISTANCES) {
+        const { metrics } = replay(usable, maxDistance);
+        console.log(`${String(maxDistance).padStart(12)}  ${(metrics.hit_rate * 100).toFixed(0).padStart(7)}%  ` +
+                    `${String(metrics.lookups - metrics.hits).padStart(8)}  ${String(metrics.latency_saved_ms).padStart(10)} ms`);
+    }
+}
+
+main();
@@ -0,0 +1,143 @@
+// Minimal MessagePack encoder and the compact /analyze response schema.
+//
+// Compact schema (version 1), decoded by main/response_codec.c on the device:
+//   [ version, faces, unknown_faces, objects, context, cache_hit, burst ]
+//   faces/objects: [ name, confidence (per-mille), box ]
+//   box:           null or [ x, y, w, h ] (per-mille of the frame)
+// Fields may only be appended; the firmware ignores trailing elements.
+
+const SCHEMA_VERSION = 1;
+const MSGPACK_CONTENT_TYPE = 'application/msgpack';
+
+function encodeValue(value, out) {
+    if (value === null || value === undefined) {
+        out.push(Buffer.from([0xc0]));
+    } else if (typeof value === 'boolean') {
+        out.push(Buffer.from([value ? 0xc3 : 0xc2]));
+    } else if (typeof value === 'number') {
+        encodeNumber(value, out);
+    } else if (typeof value === 'string') {
+        encodeString(value, out);
+    } else if (Array.isArray(value)) {
+        encodeHeader(value.length, 0x90, 0x0f, 0xdc, 0xdd, out);
+        value.forEach(item => encodeValue(item, out));
+    } else if (typeof value === 'object') {
+        const keys = Object.keys(value).filter(key => value[key] !== undefined);
+        encodeHeader(keys.length, 0x80, 0x0f, 0xde, 0xdf, out);
+        keys.forEach(key => {
+            encodeString(key, out);
+            encodeValue(value[key], out);
+        });
+    } else {
+        throw new TypeError(`Cannot encode ${typeof value} as MessagePack`);
+    }
+}
+
+function encodeHeader(length, fixBase, fixMax, tag16, tag32, out) {
+    if (length <= fixMax) {
+        out.push(Buffer.from([fixBase | length]));
+    } else if (length <= 0xffff) {
+        const buf = Buffer.alloc(3);
+        buf[0] = tag16;
+        buf.writeUInt16BE(length, 1);
+        out.push(buf);
+    } else {
+        const buf = Buffer.alloc(5);
+        buf[0] = tag32;
+        buf.writeUInt32BE(length, 1);
+        out.push(buf);
+    }
+}
+
+function encodeNumber(value, out) {
+    if (!Number.isInteger(value)) {
+        const buf = Buffer.alloc(9);
+        buf[0] = 0xcb;
+        buf.writeDoubleBE(value, 1);
+        out.push(buf);
+    } else if (value >= 0 && value <= 0x7f) {
+        out.push(Buffer.from([value]));
+    } else if (value >= 0 && value <= 0xff) {
+        out.push(Buffer.from([0xcc, value]));
+    } else if (value >= 0 && value <= 0xffff) {
+        const buf = Buffer.alloc(3);
+        buf[0] = 0xcd;
+        buf.writeUInt16BE(value, 1);
+        out.push(buf);
+    } else if (value >= 0 && value <= 0xffffffff) {
+        const buf = Buffer.alloc(5);
+        buf[0] = 0xce;
+        buf.writeUInt32BE(value, 1);
+        out.push(buf);
+    } else if (value < 0 && value >= -32) {
+        out.push(Buffer.from([value & 0xff]));
+    } else if (value < 0 && value >= -0x80000000) {
+        const buf = Buffer.alloc(5);
+        buf[0] = 0xd2;
+        buf.writeInt32BE(value, 1);
+        out.push(buf);
+    } else {
+        const buf = Buffer.alloc(9);
+        buf[0] = 0xcb;
+        buf.writeDoubleBE(value, 1);
+        out.push(buf);
+    }
+}
+
+function encodeString(value, out) {
+    const bytes = Buffer.from(value, 'utf8');
+    if (bytes.length <= 0x1f) {
+        out.push(Buffer.from([0xa0 | bytes.length]));
+    } else if (bytes.length <= 0xff) {
+        out.push(Buffer.from([0xd9, bytes.length]));
+    } else if (bytes.length <= 0xffff) {
+        const buf = Buffer.alloc(3);
+        buf[0] = 0xda;
+        buf.writeUInt16BE(bytes.length, 1);
+        out.push(buf);
+    } else {
+        const buf = Buffer.alloc(5);
+        buf[0] = 0xdb;
+        buf.writeUInt32BE(bytes.length, 1);
+        out.push(buf);
+    }
+    out.push(bytes);
+}
+
+function encode(value) {
+    const out = [];
+    encodeValue(value, out);
+    return Buffer.concat(out);
+}
+
+// Helper function to scale a 0.0 - 1.0 value to an integer per-mille
+function perMille(value) {
+    return Math.max(0, Math.min(1000, Math.round(value * 1000)));
+}
+
+function compactDetection(item) {
+    const box = item.box
+        ? [perMille(item.box.x), perMille(item.box.y), perMille(item.box.w), perMille(item.box.h)]
+        : null;
+    return [item.name, perMille(item.confidence), box];
+}
+
+// Encodes an analysis response into the compact schema, echo fields are dropped
+function encodeCompactResponse(response) {
+    return encode([
+        SCHEMA_VERSION,
+        (response.recognized_faces || []).map(compactDetection),
+        response.unknown_faces || 0,
+        (response.objects || []).map(compactDetection),
+        response.context || null,
+        response.cache_hit === true,
+        response.burst === true
+    ]);
+}
+
+module.exports = {
+    SCHEMA_VERSION,
+    MSGPACK_CONTENT_TYPE,
+    encode,
+    encodeCompactResponse
+};
@@ -0,0 +1,191 @@
+// Perceptual-hash result cache for near-duplicate frames.
+//
+// Each decoded frame is reduced to a 64-bit difference hash (dHash): grayscale,
+// box-averaged down to 9x8, one bit per horizontally adjacent pair. Frames whose
+// hashes are within maxDistance bits and whose cached result is younger than
+// maxAgeMs reuse that result instead of being analyzed again. Entries live in a
+// small LRU per device, backed by a larger LRU shared across devices.
+
+const jpeg = require('jpeg-js');
+
+const HASH_WIDTH = 9;
+const HASH_HEIGHT = 8;
+
+const DEFAULT_OPTIONS = {
+    maxDistance: 6,         // Hamming distance (of 64 bits) still treated as the same scene
+    maxAgeMs: 10000,
+    deviceEntries: 16,
+    sharedEntries: 128,
+    maxDevices: 64,
+    now: Date.now           // Clock for entry ages, replays pass a simulated one
+};
+
+// Box-averages an RGBA image down to HASH_WIDTH x HASH_HEIGHT luma values
+function downsampleLuma(data, width, height) {
+    const cells = new Float64Array(HASH_WIDTH * HASH_HEIGHT);
+    const counts = new Uint32Array(HASH_WIDTH * HASH_HEIGHT);
+
+    for (let y = 0; y < height; y++) {
+        const cy = Math.min(HASH_HEIGHT - 1, Math.floor(y * HASH_HEIGHT / height));
+        for (let x = 0; x < width; x++) {
+            const cx = Math.min(HASH_WIDTH - 1, Math.floor(x * HASH_WIDTH / width));
+            const i = (y * width + x) * 4;
+            const cell = cy * HASH_WIDTH + cx;
+            cells[cell] += 0.299 * data[i] + 0.587 * data[i + 1] + 0.114 * data[i + 2];
+            counts[cell]++;
+        }
+    }
+
+    for (let i = 0; i < cells.length; i++) {
+        cells[i] = counts[i] ? cells[i] / counts[i] : 0;
+    }
+    return cells;
+}
+
+// dHash of raw RGBA pixels, as a BigInt
+function hashPixels(data, width, height) {
+    const cells = downsampleLuma(data, width, height);
+    let hash = 0n;
+    for (let y = 0; y < HASH_HEIGHT; y++) {
+        for (let x = 0; x < HASH_WIDTH - 1; x++) {
+            const bit = cells[y * HASH_WIDTH + x] > cells[y * HASH_WIDTH + x + 1] ? 1n : 0n;
+            hash = (hash << 1n) | bit;
+        }
+    }
+    return hash;
+}
+
+// dHash of a JPEG, or null when it can't be decoded
+function hashJpeg(buffer) {
+    try {
+        const image = jpeg.decode(buffer, { useTArray: true, formatAsRGBA: true });
+        return hashPixels(image.data, image.width, image.height);
+    } catch (error) {
+        return null;
+    }
+}
+
+function hammingDistance(a, b) {
+    let x = a ^ b;
+    let count = 0;
+    while (x) {
+        x &= x - 1n;
+        count++;
+    }
+    return count;
+}
+
+// Insertion-ordered Map used as an LRU: a hit is moved to the back, eviction takes the front
+class LruList {
+    constructor(capacity) {
+        this.capacity = capacity;
+        this.entries = new Map();
+        this.nextKey = 0;
+    }
+
+    findNear(hash, maxDistance, minCreatedAt) {
+        let best = null;
+        let bestKey = null;
+        let bestDistance = maxDistance + 1;
+
+        for (const [key, entry] of this.entries) {
+            if (entry.createdAt < minCreatedAt) {
+                this.entries.delete(key);
+                continue;
+            }
+            const distance = hammingDistance(hash, entry.hash);
+            if (distance < bestDistance) {
+                best = entry;
+                bestKey = key;
+                bestDistance = distance;
+            }
+        }
+
+        if (best) {
+            this.entries.delete(bestKey);
+            this.entries.set(bestKey, best);
+        }
+        return best;
+    }
+
+    add(entry) {
+        this.entries.set(this.nextKey++, entry);
+        while (this.entries.size > this.capacity) {
+            this.entries.delete(this.entries.keys().next().value);
+        }
+    }
+}
+
+class ResultCache {
+    constructor(options = {}) {
+        this.options = { ...DEFAULT_OPTIONS, ...options };
+        this.devices = new Map();
+        this.shared = new LruList(this.options.sharedEntries);
+        this.stats = { lookups: 0, deviceHits: 0, sharedHits: 0, savedMs: 0 };
+    }
+
+    // Devices are kept in use order too, so the one evicted is the longest idle
+    deviceList(deviceId) {
+        let list = this.devices.get(deviceId);
+        if (list) {
+            this.devices.delete(deviceId);
+        } else {
+            list = new LruList(this.options.deviceEntries);
+        }
+        this.devices.set(deviceId, list);
+        if (this.devices.size > this.options.maxDevices) {
+            this.devices.delete(this.devices.keys().next().value);
+        }
+        return list;
+    }
+
+    // Returns the cached response for a near-identical frame, or null
+    lookup(deviceId, hash) {
+        if (hash === null) {
+            return null;
+        }
+        this.stats.lookups++;
+
+        const minCreatedAt = this.options.now() - this.options.maxAgeMs;
+        let entry = this.deviceList(deviceId).findNear(hash, this.options.maxDistance, minCreatedAt);
+        if (entry) {
+            this.stats.deviceHits++;
+        } else {
+            entry = this.shared.findNear(hash, this.options.maxDistance, minCreatedAt);
+            if (entry) {
+                this.stats.sharedHits++;
+            }
+        }
+
+        if (!entry) {
+            return null;
+        }
+        this.stats.savedMs += entry.serviceMs;
+        return entry.response;
+    }
+
+    store(deviceId, hash, response, serviceMs) {
+        if (hash === null) {
+            return;
+        }
+        const entry = { hash, response, serviceMs, createdAt: this.options.now() };
+        this.deviceList(deviceId).add(entry);
+        this.shared.add(entry);
+    }
+
+    getMetrics() {
+        const hits = this.stats.deviceHits + this.stats.sharedHits;
+        return {
+            lookups: this.stats.lookups,
+            hits,
+            device_hits: this.stats.deviceHits,
+            shared_hits: this.stats.sharedHits,
+            hit_rate: this.stats.lookups ? Math.round(hits / this.stats.lookups * 1000) / 1000 : 0,
+            latency_saved_ms: Math.round(this.stats.savedMs),
+            max_distance: this.options.maxDistance,
+            max_age_ms: this.options.maxAgeMs
+        };
+    }
+}
+
+module.exports = { ResultCache, hashJpeg, hashPixels, hammingDistance };
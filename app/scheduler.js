@@ -0,0 +1,296 @@
+// Per-device sessions and weighted fair scheduling for /analyze.
+//
+// Every device_id gets a session with a token-bucket rate limit, an in-flight cap
+// and a short history of results. Requests answered from the result cache are
+// reserved against the same limits and recorded like analyses. Admitted jobs are
+// ordered with self-clocked fair queueing: each job is tagged with
+// max(virtual time, session's last tag) + 1 / weight,
+// and the lowest tag runs next. A device that floods the queue only pushes its own
+// tags further out, so other devices keep getting served in between. A device with
+// weight 2 gets twice the share of one with weight 1 while both are busy. The queue
+// across all devices is bounded too, past that the server is saturated.
+
+const DEFAULT_OPTIONS = {
+    concurrency: 2,             // Jobs analyzed at the same time
+    maxQueued: Infinity,        // Jobs waiting across all devices
+    ratePerSec: 1,              // Sustained requests per second per device
+    burst: 3,                   // Bucket size per device
+    maxInFlightPerDevice: 2,    // Queued + running jobs per device
+    recentResults: 5,           // Results kept per session
+    sessionIdleMs: 10 * 60 * 1000,
+    weights: {},                // device_id -> share of the analysis time, 1 when not listed
+    defaultWeight: 1
+};
+
+function createTimingStats() {
+    return { count: 0, totalMs: 0, maxMs: 0 };
+}
+
+function recordTiming(stats, ms) {
+    stats.count++;
+    stats.totalMs += ms;
+    stats.maxMs = Math.max(stats.maxMs, ms);
+}
+
+function summarizeTiming(stats) {
+    return {
+        count: stats.count,
+        avg_ms: stats.count ? Math.round(stats.totalMs / stats.count) : 0,
+        max_ms: Math.round(stats.maxMs)
+    };
+}
+
+class FairScheduler {
+    constructor(options = {}) {
+        this.options = { ...DEFAULT_OPTIONS, ...options };
+        this.sessions = new Map();
+        this.queue = [];
+        this.running = 0;
+        this.virtualTime = 0;
+        this.service = createTimingStats();
+
+        // Drop sessions of devices that went away
+        this.sweepTimer = setInterval(() => this.sweepSessions(), this.options.sessionIdleMs);
+        this.sweepTimer.unref();
+    }
+
+    getSession(deviceId) {
+        let session = this.sessions.get(deviceId);
+        if (!session) {
+            session = {
+                deviceId,
+                weight: this.weightFor(deviceId),
+                tokens: this.options.burst,
+                lastRefill: Date.now(),
+                lastSeen: Date.now(),
+                lastFinishTag: 0,
+                inFlight: 0,
+                recent: [],
+                requests: 0,
+                cacheHits: 0,
+                rejected: 0,
+                queueWait: createTimingStats(),
+                service: createTimingStats()
+            };
+            this.sessions.set(deviceId, session);
+        }
+        return session;
+    }
+
+    weightFor(deviceId) {
+        const weight = Number(this.options.weights[deviceId]);
+        return weight > 0 ? weight : this.options.defaultWeight;
+    }
+
+    // Applies to jobs submitted from now on, queued jobs keep their tags
+    setWeight(deviceId, weight) {
+        this.options.weights = { ...this.options.weights, [deviceId]: weight };
+        const session = this.sessions.get(deviceId);
+        if (session) {
+            session.weight = this.weightFor(deviceId);
+        }
+    }
+
+    refill(session, now) {
+        const elapsed = (now - session.lastRefill) / 1000;
+        session.tokens = Math.min(this.options.burst, session.tokens + elapsed * this.options.ratePerSec);
+        session.lastRefill = now;
+    }
+
+    // Charges one request to deviceId's rate limit and in-flight cap before any work is done
+    // for it, cache lookups included. Returns { accepted: true, reservation } to pass to
+    // enqueue(), completeCached() or release(), or { accepted: false, retryAfterMs }.
+    reserve(deviceId) {
+        const now = Date.now();
+        const session = this.getSession(deviceId);
+        session.lastSeen = now;
+        this.refill(session, now);
+
+        if (session.tokens < 1 || session.inFlight >= this.options.maxInFlightPerDevice) {
+            session.rejected++;
+            const refillMs = Math.ceil((1 - session.tokens) / this.options.ratePerSec * 1000);
+            const avgServiceMs = summarizeTiming(session.service).avg_ms;
+            return {
+                accepted: false,
+                retryAfterMs: Math.max(refillMs, session.inFlight >= this.options.maxInFlightPerDevice ? avgServiceMs : 0, 100)
+            };
+        }
+
+        session.tokens -= 1;
+        session.inFlight++;
+        session.requests++;
+        return { accepted: true, reservation: { session, state: 'reserved' } };
+    }
+
+    // A reserved request answered from the result cache, kept in the session like an analysis
+    completeCached(reservation, result) {
+        if (reservation.state !== 'reserved') {
+            return;
+        }
+        reservation.state = 'done';
+        const { session } = reservation;
+        session.inFlight--;
+        session.cacheHits++;
+        this.remember(session, result);
+    }
+
+    // A reserved request that ended without a result, e.g. the frame failed before analysis.
+    // The token stays spent, only the in-flight slot is returned.
+    release(reservation) {
+        if (reservation.state !== 'reserved') {
+            return;
+        }
+        reservation.state = 'done';
+        reservation.session.inFlight--;
+    }
+
+    // Queues run() for a reserved request, or returns { accepted: false, saturated: true, retryAfterMs }
+    // when the queue is full for everyone. A saturated request gets its token back.
+    enqueue(reservation, run) {
+        const { session } = reservation;
+        if (reservation.state !== 'reserved') {
+            throw new Error('Request was not reserved or already finished');
+        }
+
+        if (this.queue.length >= this.options.maxQueued) {
+            reservation.state = 'done';
+            session.inFlight--;
+            session.requests--;
+            session.rejected++;
+            session.tokens = Math.min(this.options.burst, session.tokens + 1);
+            // Roughly the time it takes the jobs already queued to start
+            const avgServiceMs = summarizeTiming(this.service).avg_ms || 1000;
+            return {
+                accepted: false,
+                saturated: true,
+                retryAfterMs: Math.max(Math.ceil(avgServiceMs * this.queue.length / this.options.concurrency), 100)
+            };
+        }
+        reservation.state = 'queued';
+
+        const finishTag = Math.max(this.virtualTime, session.lastFinishTag) + 1 / session.weight;
+        session.lastFinishTag = finishTag;
+
+        const promise = new Promise((resolve, reject) => {
+            this.queue.push({ session, run, finishTag, enqueuedAt: Date.now(), resolve, reject });
+        });
+        this.dispatch();
+
+        return { accepted: true, promise };
+    }
+
+    // Queues run() for deviceId, or returns { accepted: false, retryAfterMs, saturated } when the device
+    // is over its limits or, with saturated set, when the queue is full for everyone
+    submit(deviceId, run) {
+        const reserved = this.reserve(deviceId);
+        if (!reserved.accepted) {
+            return reserved;
+        }
+        return this.enqueue(reserved.reservation, run);
+    }
+
+    // Keeps result in the session's recent history
+    remember(session, result) {
+        session.recent.push({ timestamp: Date.now(), result });
+        if (session.recent.length > this.options.recentResults) {
+            session.recent.shift();
+        }
+    }
+
+    dispatch() {
+        while (this.running < this.options.concurrency && this.queue.length > 0) {
+            let next = 0;
+            for (let i = 1; i < this.queue.length; i++) {
+                if (this.queue[i].finishTag < this.queue[next].finishTag) {
+                    next = i;
+                }
+            }
+            const job = this.queue.splice(next, 1)[0];
+            this.start(job);
+        }
+    }
+
+    start(job) {
+        const { session } = job;
+        const startedAt = Date.now();
+        this.running++;
+        this.virtualTime = job.finishTag;
+        recordTiming(session.queueWait, startedAt - job.enqueuedAt);
+
+        Promise.resolve()
+            .then(() => job.run())
+            .then(result => {
+                this.remember(session, result);
+                job.resolve(result);
+            }, job.reject)
+            .finally(() => {
+                recordTiming(session.service, Date.now() - startedAt);
+                recordTiming(this.service, Date.now() - startedAt);
+                session.inFlight--;
+                this.running--;
+                this.dispatch();
+            });
+    }
+
+    sweepSessions() {
+        const cutoff = Date.now() - this.options.sessionIdleMs;
+        for (const [deviceId, session] of this.sessions) {
+            if (session.inFlight === 0 && session.lastSeen < cutoff) {
+                this.sessions.delete(deviceId);
+            }
+        }
+    }
+
+    getSessionInfo(deviceId) {
+        const session = this.sessions.get(deviceId);
+        if (!session) {
+            return null;
+        }
+        return {
+            device_id: deviceId,
+            in_flight: session.inFlight,
+            requests: session.requests,
+            cache_hits: session.cacheHits,
+            rejected: session.rejected,
+            recent_results: session.recent
+        };
+    }
+
+    getMetrics() {
+        const devices = {};
+        for (const [deviceId, session] of this.sessions) {
+            devices[deviceId] = {
+                weight: session.weight,
+                requests: session.requests,
+                cache_hits: session.cacheHits,
+                rejected: session.rejected,
+                in_flight: session.inFlight,
+                queue_wait: summarizeTiming(session.queueWait),
+                service_time: summarizeTiming(session.service)
+            };
+        }
+        return {
+            concurrency: this.options.concurrency,
+            running: this.running,
+            queued: this.queue.length,
+            max_queued: this.options.maxQueued,
+            service_time: summarizeTiming(this.service),
+            devices
+        };
+    }
+}
+
+// "cam-1=2,cam-2=0.5" -> { 'cam-1': 2, 'cam-2': 0.5 }, entries that don't parse are skipped
+function parseWeights(spec) {
+    const weights = {};
+    for (const entry of (spec || '').split(',')) {
+        const [deviceId, value] = entry.split('=').map(part => part && part.trim());
+        const weight = Number(value);
+        if (deviceId && weight > 0) {
+            weights[deviceId] = weight;
+        }
+    }
+    return weights;
+}
+
+module.exports = { FairScheduler, parseWeights };
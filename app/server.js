@@ -2,10 +2,50 @@ const express = require('express');
 const cors = require('cors');
 const fs = require('fs');
 const path = require('path');
+const { MSGPACK_CONTENT_TYPE, encodeCompactResponse } = require('./msgpack');
+const { FairScheduler, parseWeights } = require('./scheduler');
+const { ResultCache } = require('./phash_cache');
+const { WorkerPool, decodeImage } = require('./worker_pool');
 
 const app = express();
 const PORT = process.env.PORT || 3000;
 
+// Analysis runs on worker threads, the backend is a module in ./backends
+const ANALYSIS_BACKEND = process.env.ANALYSIS_BACKEND || 'mock';
+const ANALYSIS_WORKERS = Number(process.env.ANALYSIS_WORKERS || 2);
+const pool = new WorkerPool({ size: ANALYSIS_WORKERS, backend: ANALYSIS_BACKEND });
+
+// Per-device sessions, fair queueing across devices and per-device rate limits.
+// The scheduler hands the pool one job per worker, the fair queue is the bounded queue in front of it.
+const scheduler = new FairScheduler({
+    concurrency: ANALYSIS_WORKERS,
+    maxQueued: Number(process.env.ANALYSIS_QUEUE_LIMIT || 8),
+    ratePerSec: Number(process.env.DEVICE_RATE_PER_SEC || 1),
+    burst: Number(process.env.DEVICE_RATE_BURST || 3),
+    maxInFlightPerDevice: Number(process.env.DEVICE_MAX_IN_FLIGHT || 2),
+    weights: parseWeights(process.env.DEVICE_WEIGHTS)   // e.g. "goggles-1=2,kitchen-cam=0.5"
+});
+
+// Results with a detection below this confidence ask the device for a burst capture, 0 disables the hint
+const BURST_HINT_CONFIDENCE = Number(process.env.BURST_HINT_CONFIDENCE || 0.75);
+
+// Near-duplicate frames reuse a recent analysis instead of being analyzed again
+const CACHE_ENABLED = process.env.CACHE_ENABLED !== 'false';
+const resultCache = new ResultCache({
+    maxDistance: Number(process.env.CACHE_MAX_DISTANCE || 6),
+    maxAgeMs: Number(process.env.CACHE_MAX_AGE_MS || 10000)
+});
+
+// Frames are decoded and hashed on a pool of their own, the image comes back with the hash.
+// When it is busy a frame skips the cache lookup rather than waiting.
+const HASH_WORKERS = Number(process.env.HASH_WORKERS || 1);
+const hashPool = CACHE_ENABLED ? new WorkerPool({
+    size: HASH_WORKERS,
+    maxQueue: Number(process.env.HASH_QUEUE_LIMIT || 8),
+    backend: 'phash',
+    returnImage: true
+}) : null;
+
 // Middleware
 app.use(cors());
 app.use(express.json({ limit: '10mb' })); // Increase limit for base64 images
@@ -17,46 +57,9 @@ if (!fs.existsSync(uploadsDir)) {
     fs.mkdirSync(uploadsDir);
 }
 
-// Mock data for responses
-const mockFaces = [
-    { name: "Alice", confidence: 0.95 },
-    { name: "Bob", confidence: 0.87 },
-    { name: "Charlie", confidence: 0.92 },
-    { name: "Diana", confidence: 0.89 }
-];
-
-const mockObjects = [
-    { name: "coffee cup", confidence: 0.85 },
-    { name: "laptop", confidence: 0.78 },
-    { name: "phone", confidence: 0.92 },
-    { name: "book", confidence: 0.76 },
-    { name: "water bottle", confidence: 0.83 },
-    { name: "pen", confidence: 0.71 },
-    { name: "chair", confidence: 0.89 },
-    { name: "table", confidence: 0.94 }
-];
-
-const mockContexts = [
-    "You're in an office environment",
-    "Looks like a coffee break",
-    "Study session in progress",
-    "Meeting room setting",
-    "Working from home setup",
-    "Outdoor environment detected",
-    "Kitchen area identified",
-    "Living room space"
-];
-
-// Helper function to get random items from array
-function getRandomItems(array, count) {
-    const shuffled = [...array].sort(() => 0.5 - Math.random());
-    return shuffled.slice(0, count);
-}
-
 // Helper function to save image (optional for debugging)
-function saveImage(base64Data, filename) {
+function saveImage(buffer, filename) {
     try {
-        const buffer = Buffer.from(base64Data, 'base64');
         const filepath = path.join(uploadsDir, filename);
         fs.writeFileSync(filepath, buffer);
         console.log(`Image saved: ${filepath}`);
@@ -65,6 +68,52 @@ function saveImage(base64Data, filename) {
     }
 }
 
+// Resolves { hash, image } for a frame from decodeImage(), hash is null when it isn't looked up in the cache
+function hashFrame(image) {
+    const job = hashPool ? hashPool.submit(image, {}) : { accepted: false };
+    if (!job.accepted) {
+        return Promise.resolve({ hash: null, image });
+    }
+    return job.promise.then(({ result, image }) => ({ hash: result, image }));
+}
+
+// Runs one analysis on the worker pool, image must come from decodeImage() and is handed over
+function runAnalysis(image, device_id) {
+    const job = pool.submit(image, { device_id });
+    if (!job.accepted) {
+        const error = new Error('Analysis pool saturated');
+        error.retryAfterMs = job.retryAfterMs;
+        return Promise.reject(error);
+    }
+    return job.promise;
+}
+
+// Helper function to decide whether a sharper shot is worth a burst on the device
+function wantsBurst(response) {
+    const detections = [...(response.recognized_faces || []), ...(response.objects || [])];
+    return detections.some(item => item.confidence < BURST_HINT_CONFIDENCE);
+}
+
+// Helper function to tell a device to back off, the firmware honors both headers
+function sendRetryAfter(res, status, error, retryAfterMs) {
+    res.set('Retry-After', String(Math.ceil(retryAfterMs / 1000)));
+    res.set('Retry-After-Ms', String(retryAfterMs));
+    res.status(status).json({
+        error,
+        retry_after_ms: retryAfterMs
+    });
+}
+
+// Helper function to send a response in the encoding the client asked for
+function sendAnalysis(req, res, response) {
+    // JSON stays the default, the compact encoding is only sent when asked for
+    if (req.accepts(['application/json', MSGPACK_CONTENT_TYPE]) === MSGPACK_CONTENT_TYPE) {
+        res.type(MSGPACK_CONTENT_TYPE).send(encodeCompactResponse(response));
+    } else {
+        res.json(response);
+    }
+}
+
 // Main analysis endpoint
 app.post('/analyze', (req, res) => {
     console.log('Received analysis request');
@@ -78,56 +127,64 @@ app.post('/analyze', (req, res) => {
         
         console.log(`Processing image from device: ${device_id} at ${timestamp}`);
         
+        // Decoded once into a buffer of its own, it is transferred to the analysis worker
+        const imageBytes = decodeImage(image);
+
         // Optionally save the image for debugging
         if (process.env.SAVE_IMAGES === 'true') {
             const filename = `${device_id}_${timestamp}.jpg`;
-            saveImage(image, filename);
+            saveImage(imageBytes, filename);
         }
-        
-        // Simulate processing time
-        setTimeout(() => {
-            // Generate random mock response
-            const shouldDetectFaces = Math.random() > 0.3; // 70% chance of faces
-            const shouldDetectObjects = Math.random() > 0.2; // 80% chance of objects
-            const shouldHaveUnknown = Math.random() > 0.7; // 30% chance of unknown faces
-            
-            const response = {
-                status: 'success',
-                timestamp: Date.now(),
-                device_id: device_id,
-                processing_time: Math.round(Math.random() * 2000 + 500), // 500-2500ms
-                recognized_faces: [],
-                unknown_faces: 0,
-                objects: [],
-                context: null
-            };
-            
-            // Add recognized faces
-            if (shouldDetectFaces) {
-                const numFaces = Math.floor(Math.random() * 3) + 1; // 1-3 faces
-                response.recognized_faces = getRandomItems(mockFaces, numFaces);
-            }
-            
-            // Add unknown faces
-            if (shouldHaveUnknown) {
-                response.unknown_faces = Math.floor(Math.random() * 2) + 1; // 1-2 unknown
+
+        // Charged before hashing, so cache hits count against the rate limit and a
+        // chatty device holds at most its in-flight cap of the shared hash pool
+        const deviceKey = device_id || req.ip;
+        const reserved = scheduler.reserve(deviceKey);
+        if (!reserved.accepted) {
+            console.log(`Rate limited device: ${device_id}, retry after ${reserved.retryAfterMs}ms`);
+            return sendRetryAfter(res, 429, 'Too many requests', reserved.retryAfterMs);
+        }
+        const { reservation } = reserved;
+
+        hashFrame(imageBytes).then(({ hash, image }) => {
+            const cached = resultCache.lookup(deviceKey, hash);
+            if (cached) {
+                console.log(`Cache hit for device: ${device_id}`);
+                const response = { ...cached, timestamp: Date.now(), device_id, cache_hit: true };
+                scheduler.completeCached(reservation, response);
+                return sendAnalysis(req, res, response);
             }
-            
-            // Add objects
-            if (shouldDetectObjects) {
-                const numObjects = Math.floor(Math.random() * 4) + 1; // 1-4 objects
-                response.objects = getRandomItems(mockObjects, numObjects);
+
+            // Queue behind other devices' work, or tell this device when to come back
+            const job = scheduler.enqueue(reservation, () => {
+                const startedAt = Date.now();
+                return runAnalysis(image, device_id).then(response => {
+                    resultCache.store(deviceKey, hash, response, Date.now() - startedAt);
+                    return response;
+                });
+            });
+            if (!job.accepted) {
+                console.log(`Analysis saturated, device: ${device_id}, retry after ${job.retryAfterMs}ms`);
+                return sendRetryAfter(res, 503, 'Analysis capacity exhausted', job.retryAfterMs);
             }
-            
-            // Add context
-            if (Math.random() > 0.4) { // 60% chance of context
-                response.context = mockContexts[Math.floor(Math.random() * mockContexts.length)];
+
+            return job.promise.then(response => {
+                response = { ...response, cache_hit: false, burst: wantsBurst(response) };
+                console.log('Sending response:', JSON.stringify(response, null, 2));
+                sendAnalysis(req, res, response);
+            });
+        }).catch(error => {
+            // Only frees the slot when the request failed before it was queued
+            scheduler.release(reservation);
+            if (error.retryAfterMs !== undefined) {
+                return sendRetryAfter(res, 503, 'Analysis capacity exhausted', error.retryAfterMs);
             }
-            
-            console.log('Sending response:', JSON.stringify(response, null, 2));
-            res.json(response);
-            
-        }, Math.random() * 1000 + 200); // 200-1200ms delay
+            console.error('Error analyzing image:', error);
+            res.status(500).json({
+                error: 'Internal server error',
+                message: error.message
+            });
+        });
         
     } catch (error) {
         console.error('Error processing request:', error);
@@ -138,6 +195,26 @@ app.post('/analyze', (req, res) => {
     }
 });
 
+// Scheduler metrics (per-device requests, cache hits, queue wait and service time), worker pool loads and result cache hit rate
+app.get('/metrics', (req, res) => {
+    res.json({
+        timestamp: Date.now(),
+        scheduler: scheduler.getMetrics(),
+        pool: pool.getMetrics(),
+        hash_pool: hashPool ? hashPool.getMetrics() : null,
+        cache: resultCache.getMetrics()
+    });
+});
+
+// Session state for one device: in-flight requests and recent results
+app.get('/sessions/:device_id', (req, res) => {
+    const session = scheduler.getSessionInfo(req.params.device_id);
+    if (!session) {
+        return res.status(404).json({ error: 'Unknown device' });
+    }
+    res.json(session);
+});
+
 // Health check endpoint
 app.get('/health', (req, res) => {
     res.json({ 
@@ -154,12 +231,19 @@ app.get('/', (req, res) => {
         version: '1.0.0',
         endpoints: {
             analyze: 'POST /analyze - Send base64 image for analysis',
-            health: 'GET /health - Check server status'
+            health: 'GET /health - Check server status',
+            metrics: 'GET /metrics - Per-device requests, cache hits, queue wait and service time, worker pool load, cache hit rate and latency saved',
+            session: 'GET /sessions/:device_id - In-flight requests, cache hits and recent results, reused ones included'
         },
         usage: {
             image_format: 'base64 encoded JPEG',
             max_size: '10MB',
-            response_format: 'JSON with faces, objects, and context'
+            rate_limit: '429 with Retry-After (s) and Retry-After-Ms headers when a device exceeds its share, cache hits included',
+            saturation: '503 with the same headers when the analysis queue is full for all devices',
+            response_format: 'JSON with faces, objects, and context, cache_hit is true for reused results',
+            compact_format: `send "Accept: ${MSGPACK_CONTENT_TYPE}" for the MessagePack schema in msgpack.js`,
+            bounding_boxes: 'optional "box": { x, y, w, h } per face/object, normalized to 0.0 - 1.0',
+            burst: '"burst": true asks the device to send the sharpest of a short burst next'
         }
     });
 });
@@ -180,6 +264,12 @@ app.listen(PORT, () => {
     console.log(`🔗 Analyze endpoint: http://localhost:${PORT}/analyze`);
     console.log(`❤️  Health check: http://localhost:${PORT}/health`);
     
+    const backendInfo = pool.backend.describe ? pool.backend.describe() : ANALYSIS_BACKEND;
+    console.log(`🧠 Analysis backend: ${backendInfo} on ${ANALYSIS_WORKERS} workers`);
+    if (hashPool) {
+        console.log(`🔎 Result cache: frames hashed on ${HASH_WORKERS} worker(s)`);
+    }
+
     if (process.env.SAVE_IMAGES === 'true') {
         console.log(`💾 Images will be saved to: ${uploadsDir}`);
     }
@@ -0,0 +1,189 @@
+// Bounded pool of analysis workers.
+//
+// Each worker is a worker_threads thread that loads one backend from ./backends
+// (a module exporting analyze(image, meta) and optionally describe()). Jobs beyond
+// the idle workers wait in a FIFO of at most maxQueue entries, and submit() refuses
+// with a retry hint once that is full. Image buffers are transferred to the worker,
+// so callers must hand over a buffer they no longer need. Pools created with
+// returnImage get it transferred back with the result, for work that only reads
+// the image before it moves on (hashing ahead of analysis).
+
+const path = require('path');
+const { Worker } = require('worker_threads');
+
+const DEFAULT_OPTIONS = {
+    size: 2,            // Worker threads
+    maxQueue: 2,        // Jobs waiting for a worker
+    backend: 'mock',
+    returnImage: false  // Resolve with { result, image } instead of just the result
+};
+
+const WORKER_SCRIPT = path.join(__dirname, 'analysis_worker.js');
+
+// ArrayBuffers created by decodeImage(), the only ones safe to detach on transfer
+const ownedBuffers = new WeakSet();
+
+// Resolves a backend by name, only plain module names under ./backends are accepted
+function loadBackend(name) {
+    if (!/^[a-z0-9_-]+$/i.test(name)) {
+        throw new Error(`Invalid analysis backend name: ${name}`);
+    }
+    const backend = require(path.join(__dirname, 'backends', name));
+    if (typeof backend.analyze !== 'function') {
+        throw new Error(`Analysis backend ${name} does not export analyze()`);
+    }
+    return backend;
+}
+
+// Decodes base64 into its own ArrayBuffer, so it can be transferred without copying.
+// Buffer.from() would place small images in the shared Buffer pool, which can't be transferred.
+function decodeImage(base64) {
+    const bytes = Buffer.alloc(Buffer.byteLength(base64, 'base64'));
+    const length = bytes.write(base64, 'base64');
+    ownedBuffers.add(bytes.buffer);
+    return bytes.subarray(0, length);
+}
+
+class WorkerPool {
+    constructor(options = {}) {
+        this.options = { ...DEFAULT_OPTIONS, ...options };
+        this.backend = loadBackend(this.options.backend);
+        this.closed = false;
+        this.workers = [];
+        this.queue = [];
+        this.nextJobId = 0;
+        this.stats = { completed: 0, failed: 0, rejected: 0, serviceMs: 0 };
+
+        for (let i = 0; i < this.options.size; i++) {
+            this.spawn();
+        }
+    }
+
+    spawn() {
+        const slot = {
+            worker: new Worker(WORKER_SCRIPT, {
+                workerData: { backend: this.options.backend, returnImage: this.options.returnImage }
+            }),
+            job: null
+        };
+
+        slot.worker.on('message', ({ id, result, error, image, length }) => {
+            const job = slot.job;
+            if (!job || job.id !== id) {
+                return;
+            }
+            slot.job = null;
+            // A returned buffer is owned again and can be transferred on to the next pool
+            if (image) {
+                ownedBuffers.add(image);
+                job.image = new Uint8Array(image, 0, length);
+            }
+            this.finish(job, error ? new Error(error) : null, result);
+            this.dispatch();
+        });
+
+        // A crashed worker fails its job and is replaced
+        slot.worker.on('error', error => console.error('Analysis worker error:', error));
+        slot.worker.on('exit', code => {
+            this.workers.splice(this.workers.indexOf(slot), 1);
+            if (slot.job) {
+                this.finish(slot.job, new Error(`Analysis worker exited with code ${code}`));
+                slot.job = null;
+            }
+            if (!this.closed) {
+                this.spawn();
+                this.dispatch();
+            }
+        });
+
+        this.workers.push(slot);
+    }
+
+    finish(job, error, result) {
+        this.stats.serviceMs += Date.now() - job.startedAt;
+        if (error) {
+            this.stats.failed++;
+            error.image = job.image;
+            job.reject(error);
+        } else {
+            this.stats.completed++;
+            job.resolve(this.options.returnImage ? { result, image: job.image } : result);
+        }
+    }
+
+    busyCount() {
+        return this.workers.filter(slot => slot.job).length;
+    }
+
+    // Estimated wait until a queue slot frees up, from the average job time
+    retryAfterMs() {
+        const done = this.stats.completed + this.stats.failed;
+        const avgMs = done ? this.stats.serviceMs / done : 1000;
+        return Math.max(100, Math.ceil(avgMs * (this.queue.length + 1) / this.options.size));
+    }
+
+    // Queues image (from decodeImage) for analysis, or returns { accepted: false, retryAfterMs } when saturated
+    submit(image, meta) {
+        if (this.isSaturated()) {
+            this.stats.rejected++;
+            return { accepted: false, retryAfterMs: this.retryAfterMs() };
+        }
+
+        const promise = new Promise((resolve, reject) => {
+            this.queue.push({ id: this.nextJobId++, image, meta, resolve, reject });
+        });
+        this.dispatch();
+
+        return { accepted: true, promise };
+    }
+
+    isSaturated() {
+        return this.busyCount() >= this.workers.length && this.queue.length >= this.options.maxQueue;
+    }
+
+    dispatch() {
+        for (const slot of this.workers) {
+            if (this.queue.length === 0) {
+                break;
+            }
+            if (slot.job) {
+                continue;
+            }
+            const job = this.queue.shift();
+            job.startedAt = Date.now();
+            slot.job = job;
+
+            // Any other buffer may share its memory (e.g. the Buffer pool) and is copied once instead
+            const image = ownedBuffers.has(job.image.buffer) && job.image.byteOffset === 0
+                ? job.image
+                : Uint8Array.prototype.slice.call(job.image);
+            job.image = null;
+            slot.worker.postMessage(
+                { id: job.id, image: image.buffer, length: image.byteLength, meta: job.meta },
+                [image.buffer]
+            );
+        }
+    }
+
+    getMetrics() {
+        const done = this.stats.completed + this.stats.failed;
+        return {
+            backend: this.options.backend,
+            size: this.workers.length,
+            busy: this.busyCount(),
+            queued: this.queue.length,
+            max_queue: this.options.maxQueue,
+            completed: this.stats.completed,
+            failed: this.stats.failed,
+            rejected: this.stats.rejected,
+            avg_service_ms: done ? Math.round(this.stats.serviceMs / done) : 0
+        };
+    }
+
+    close() {
+        this.closed = true;
+        return Promise.all(this.workers.map(slot => slot.worker.terminate()));
+    }
+}
+
+module.exports = { WorkerPool, decodeImage, loadBackend };
@@ -3,95 +3,160 @@
 #include "camera_manager.h"
 #include "server_comm.h"
 #include "display_manager.h"
+#include "response_codec.h"
+#include "boot_manager.h"
+#include "frame_share.h"
+#include "result_tracker.h"
 #include "config.h"
 #include "esp_log.h"
-#include "cJSON.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <stdatomic.h>
 
 static const char *TAG = "AI_PROCESSOR";
+static result_tracker_t s_tracker;
+static TaskHandle_t s_task;
+static atomic_bool s_burst_requested;
+static uint32_t s_captures_since_burst;
 
 esp_err_t ai_processor_init(void) {
+    result_tracker_init(&s_tracker);
     ESP_LOGI(TAG, "AI processor initialized");
     return ESP_OK;
 }
 
-void process_server_response(const char* response) {
-    if (!response) {
+void ai_processor_request_burst(void) {
+    atomic_store(&s_burst_requested, true);
+    // Cut the capture interval short, the next capture is the burst
+    if (s_task) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+// The server's hint only marks the next capture: it still waits out the interval and
+// the stability slowdown, so a hint on every result can't turn into back-to-back bursts
+static void burst_hint(void) {
+    atomic_store(&s_burst_requested, true);
+}
+
+// A requested burst (button or server hint) or the periodic one
+static bool burst_due(void) {
+#if BURST_ENABLED
+    if (atomic_exchange(&s_burst_requested, false) ||
+        (BURST_EVERY_N_CAPTURES > 0 && ++s_captures_since_burst >= BURST_EVERY_N_CAPTURES)) {
+        s_captures_since_burst = 0;
+        return true;
+    }
+#endif
+    return false;
+}
+
+// Builds one screen of text from the active tracks: faces, unknown people, objects, then context
+static void show_tracked_scene(void) {
+    char text[160];
+    size_t len = 0;
+    text[0] = '\0';
+
+    for (int kind = TRACK_FACE; kind <= TRACK_OBJECT; kind++) {
+        for (int i = 0; i < TRACKER_MAX_TRACKS && len < sizeof(text); i++) {
+            const track_t* track = &s_tracker.tracks[i];
+            if (!track->in_use || !track->active || track->kind != (track_kind_t)kind) {
+                continue;
+            }
+            const char* fmt = kind == TRACK_FACE ? "%sHello %s!" :
+                              kind == TRACK_OBJECT ? "%sObject: %s" : "%s%s";
+            len += snprintf(text + len, sizeof(text) - len, fmt, len ? "\n" : "", track->name);
+        }
+    }
+    if (s_tracker.context[0] && len < sizeof(text)) {
+        snprintf(text + len, sizeof(text) - len, "%s%s", len ? "\n" : "", s_tracker.context);
+    }
+
+    display_show_text(text[0] ? text : "Nothing in view");
+}
+
+static void add_box(const ai_detection_t* det, display_box_t* boxes, size_t* box_count) {
+    if (!det->has_box || *box_count >= DISPLAY_MAX_BOXES) {
+        return;
+    }
+    display_box_t* box = &boxes[(*box_count)++];
+    box->x = det->x;
+    box->y = det->y;
+    box->w = det->w;
+    box->h = det->h;
+    snprintf(box->label, sizeof(box->label), "%s", det->name);
+}
+
+void process_server_response(const server_response_t* response, int64_t capture_us) {
+    if (!response || !response->body || response->len == 0) {
         ESP_LOGE(TAG, "Empty response");
         display_show_text("Empty response");
         return;
     }
 
-    ESP_LOGI(TAG, "Raw response: %s", response);
+    ai_result_t result;
+    esp_err_t err;
+    int64_t decode_start = esp_timer_get_time();
 
-    char preview[64];
-    snprintf(preview, sizeof(preview), "Resp: %.57s", response);
-    display_show_text(preview);
-    
-    cJSON *json = cJSON_Parse(response);
-    if (!json) {
-        ESP_LOGE(TAG, "Failed to parse JSON response");
+    if (response->format == SERVER_FORMAT_MSGPACK) {
+        err = response_decode_msgpack(response->body, response->len, &result);
+    } else {
+        ESP_LOGI(TAG, "Raw response: %s", (const char*)response->body);
+        err = response_decode_json((const char*)response->body, &result);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to decode response: %s", esp_err_to_name(err));
         return;
     }
-    
-    // Process recognized faces
-    cJSON *recognized_faces = cJSON_GetObjectItem(json, "recognized_faces");
-    if (cJSON_IsArray(recognized_faces)) {
-        int array_size = cJSON_GetArraySize(recognized_faces);
-        for (int i = 0; i < array_size; i++) {
-            cJSON *face = cJSON_GetArrayItem(recognized_faces, i);
-            cJSON *name = cJSON_GetObjectItem(face, "name");
-            cJSON *confidence = cJSON_GetObjectItem(face, "confidence");
-            
-            if (cJSON_IsString(name) && cJSON_IsNumber(confidence)) {
-                char display_text[64];
-                snprintf(display_text, sizeof(display_text), "Hello %s! (%.0f%%)", 
-                        name->valuestring, confidence->valuedouble * 100);
-                display_show_text(display_text);
-                ESP_LOGI(TAG, "Recognized: %s", display_text);
-            }
-        }
+    ESP_LOGI(TAG, "Decoded %d byte %s response in %lld us", (int)response->len,
+             response->format == SERVER_FORMAT_MSGPACK ? "msgpack" : "json",
+             esp_timer_get_time() - decode_start);
+
+    for (size_t i = 0; i < result.face_count; i++) {
+        ESP_LOGI(TAG, "Recognized: %s (%.0f%%)", result.faces[i].name, result.faces[i].confidence * 100);
     }
-    
-    // Process unknown faces
-    cJSON *unknown_faces = cJSON_GetObjectItem(json, "unknown_faces");
-    if (cJSON_IsNumber(unknown_faces) && unknown_faces->valueint > 0) {
-        display_show_text("Unknown person");
-        ESP_LOGI(TAG, "Unknown faces detected: %d", unknown_faces->valueint);
+    if (result.unknown_faces > 0) {
+        ESP_LOGI(TAG, "Unknown faces detected: %d", result.unknown_faces);
     }
-    
-    // Process objects
-    cJSON *objects = cJSON_GetObjectItem(json, "objects");
-    if (cJSON_IsArray(objects)) {
-        int array_size = cJSON_GetArraySize(objects);
-        for (int i = 0; i < array_size; i++) {
-            cJSON *obj = cJSON_GetArrayItem(objects, i);
-            cJSON *name = cJSON_GetObjectItem(obj, "name");
-            cJSON *confidence = cJSON_GetObjectItem(obj, "confidence");
-            
-            if (cJSON_IsString(name) && cJSON_IsNumber(confidence)) {
-                char display_text[64];
-                snprintf(display_text, sizeof(display_text), "Object: %s", name->valuestring);
-                display_show_text(display_text);
-                ESP_LOGI(TAG, "Object detected: %s (%.0f%%)", 
-                        name->valuestring, confidence->valuedouble * 100);
-            }
+    for (size_t i = 0; i < result.object_count; i++) {
+        ESP_LOGI(TAG, "Object detected: %s (%.0f%%)", result.objects[i].name, result.objects[i].confidence * 100);
+    }
+    if (result.has_context) {
+        ESP_LOGI(TAG, "Context: %s", result.context);
+    }
+    if (result.burst_requested) {
+        ESP_LOGI(TAG, "Server asked for a burst capture");
+        burst_hint();
+    }
+
+    // Only redraw the text when the tracked scene actually changed
+    bool text_drawn = result_tracker_update(&s_tracker, &result);
+    if (text_drawn) {
+        show_tracked_scene();
+    }
+
+    // Boxes follow the latest positions of tracked items, an empty set clears the overlay
+    display_box_t boxes[DISPLAY_MAX_BOXES];
+    size_t box_count = 0;
+    for (int i = 0; i < TRACKER_MAX_TRACKS; i++) {
+        const track_t* track = &s_tracker.tracks[i];
+        if (track->in_use && track->active && track->seen) {
+            add_box(&track->last, boxes, &box_count);
         }
     }
-    
-    // Process contextual information
-    cJSON *context = cJSON_GetObjectItem(json, "context");
-    if (cJSON_IsString(context)) {
-        display_show_text(context->valuestring);
-        ESP_LOGI(TAG, "Context: %s", context->valuestring);
+    bool boxes_drawn = display_overlay_update(boxes, box_count, capture_us);
+
+    // Time to first result means something on screen, not a response the tracker is still weighing
+    if (text_drawn || boxes_drawn) {
+        boot_mark(BOOT_STAGE_FIRST_RESULT, ESP_OK);
     }
-    
-    cJSON_Delete(json);
 }
 
 void ai_processing_task(void* pvParameters) {
     ESP_LOGI(TAG, "AI processing task started");
+    uint32_t frame_count = 0;
+    s_task = xTaskGetCurrentTaskHandle();
     
     while (1) {
         // Wait for WiFi connection
@@ -99,10 +164,17 @@ void ai_processing_task(void* pvParameters) {
             vTaskDelay(1000 / portTICK_PERIOD_MS);
             continue;
         }
+
+        // Don't capture while the circuit breaker is holding off a slow server
+        if (!server_comm_ready()) {
+            vTaskDelay(1000 / portTICK_PERIOD_MS);
+            continue;
+        }
         
-        // Capture frame
-        ESP_LOGI(TAG, "Attempting to capture frame...");
-        camera_fb_t* fb = camera_capture_frame();
+        // Capture frame, or the sharpest of a short burst
+        bool burst = burst_due();
+        ESP_LOGI(TAG, "Attempting to capture %s...", burst ? "burst" : "frame");
+        camera_fb_t* fb = burst ? camera_capture_burst(BURST_FRAMES) : camera_capture_frame();
         if (fb) {
             ESP_LOGI(TAG, "Captured frame! Size: %d bytes", fb->len);
         } else {
@@ -111,20 +183,47 @@ void ai_processing_task(void* pvParameters) {
             continue;
         }
         
+        shared_frame_t* frame = frame_share_wrap(fb);
+        if (!frame) {
+            camera_return_frame(fb);
+            vTaskDelay(1000 / portTICK_PERIOD_MS);
+            continue;
+        }
+#if PREVIEW_ENABLED
+        // Preview viewers stream this same buffer, no copy and no extra capture
+        frame_share_publish(frame);
+#endif
+
+        // Each frame is only worth analyzing until FRAME_MAX_AGE_MS after capture
+        int64_t capture_us = camera_frame_timestamp_us(fb);
+
+        // Show the frame being analyzed, its boxes are drawn over it when the result arrives
+        display_show_camera_frame(fb, capture_us);
+
+        int64_t deadline_us = capture_us + (int64_t)FRAME_MAX_AGE_MS * 1000;
+        
         // Indicate capture
         display_blink_status();
         
         // Send to server
-        char* response = server_send_image(fb);
-        camera_return_frame(fb);
+        server_response_t response;
+        esp_err_t err = server_send_image(fb, deadline_us, &response);
+        frame_share_release(frame);
         
-        // Process response
-        if (response) {
-            process_server_response(response);
-            free(response);
+        // Process response, late ones were already discarded by server_comm
+        if (err == ESP_OK) {
+            process_server_response(&response, capture_us);
+        }
+
+        if (++frame_count % STATS_LOG_INTERVAL_FRAMES == 0) {
+            server_comm_log_stats();
         }
         
-        // Wait before next capture
-        vTaskDelay(CAPTURE_INTERVAL_MS / portTICK_PERIOD_MS);
+        // Wait before next capture, longer while the scene isn't changing, a button burst ends it early
+        float stability = result_tracker_stability(&s_tracker);
+        uint32_t interval_ms = CAPTURE_INTERVAL_MS +
+                               (uint32_t)(stability * (CAPTURE_INTERVAL_MAX_MS - CAPTURE_INTERVAL_MS));
+        ESP_LOGD(TAG, "Scene stability %.2f, next capture in %lu ms", stability, (unsigned long)interval_ms);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(interval_ms));
     }
 }
\ No newline at end of file
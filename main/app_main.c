@@ -7,6 +7,7 @@
 //#include "esp_sntp.h"
 //#include "lwip/apps/sntp.h"
 #include "nvs_flash.h"
+#include "driver/gpio.h"
 #include "lvgl.h"
 
 #include "wifi_manager.h"
@@ -14,9 +15,94 @@
 #include "server_comm.h"
 #include "display_manager.h"
 #include "ai_processor.h"
+#include "boot_manager.h"
+#include "mem_budget.h"
+#include "preview_server.h"
+#include "config.h"
 
 static const char *TAG = "A-EYE";
 
+MEM_TASK_STORAGE(ai_task_storage, AI_TASK_STACK_SIZE);
+
+static esp_err_t boot_display(void)
+{
+    display_init();
+#if BOOT_TEST_PATTERN
+    display_test_pattern();
+#endif
+    display_show_text("Starting...");
+    return ESP_OK;
+}
+
+static esp_err_t boot_wifi(void)
+{
+    esp_err_t err = wifi_init();
+    boot_show_status("WIFI Connecting...");
+    return err;
+}
+
+static esp_err_t boot_network(void)
+{
+    wifi_wait_for_connection();
+
+    //ESP_LOGI(TAG, "Initializing SNTP...");
+    //sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    //sntp_setservername(0, "pool.ntp.org");
+    //sntp_init();
+
+//    int retry = 0;
+//    const int retry_count = 10;
+//    while (sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET && ++retry < retry_count) {
+//        ESP_LOGI(TAG, "Waiting for system time to be set... (%d/%d)", retry, retry_count);
+//        vTaskDelay(2000 / portTICK_PERIOD_MS);
+//    }
+
+    if (!wifi_is_connected()) {
+        return ESP_ERR_TIMEOUT;
+    }
+    ESP_LOGI(TAG, "WiFi Connected!");
+    boot_show_status("WiFi Connected!");
+    return ESP_OK;
+}
+
+static esp_err_t boot_server(void)
+{
+    esp_err_t err = server_comm_init();
+    if (err == ESP_OK && wifi_is_connected()) {
+        err = server_comm_prewarm();
+    }
+    return err;
+}
+
+static esp_err_t boot_ai(void)
+{
+    ai_processor_init();
+    boot_show_status("Ready!");
+
+    // Start main processing task
+    if (!mem_budget_create_task(ai_processing_task, "ai_task", AI_TASK_STACK_SIZE, NULL, 5, &ai_task_storage)) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "A-EYE Initialized Successfully");
+    return ESP_OK;
+}
+
+// Independent steps run concurrently: the camera comes up while Wi-Fi associates,
+// and the TLS connection is opened as soon as an IP is obtained
+static const boot_step_t boot_steps[] = {
+    { "boot_display", BOOT_STAGE_DISPLAY, 0, boot_display, 4096 },
+    { "boot_wifi", BOOT_STAGE_WIFI, 0, boot_wifi, 4096 },
+    { "boot_network", BOOT_STAGE_NETWORK, BOOT_BIT(BOOT_STAGE_WIFI), boot_network, 3072 },
+    { "boot_camera", BOOT_STAGE_CAMERA, 0, camera_init, 4096 },
+    { "boot_server", BOOT_STAGE_SERVER, BOOT_BIT(BOOT_STAGE_NETWORK), boot_server, 8192 },
+    { "boot_ai", BOOT_STAGE_AI,
+      BOOT_BIT(BOOT_STAGE_DISPLAY) | BOOT_BIT(BOOT_STAGE_CAMERA) | BOOT_BIT(BOOT_STAGE_SERVER), boot_ai, 4096 },
+#if PREVIEW_ENABLED
+    { "boot_preview", BOOT_STAGE_PREVIEW,
+      BOOT_BIT(BOOT_STAGE_NETWORK) | BOOT_BIT(BOOT_STAGE_CAMERA), preview_server_start, 4096 },
+#endif
+};
+
 void app_main(void)
 {
     // Initialize NVS
@@ -47,38 +133,5 @@ void app_main(void)
     lv_init();
 
     // Initialize modules
-    display_init();
-    display_test_pattern();
-    display_show_text("Starting...");
-
-    wifi_init();
-    display_show_text("WIFI Connecting...");
-    wifi_wait_for_connection();
-
-    ESP_LOGI(TAG, "Initializing SNTP...");
-    //sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    //sntp_setservername(0, "pool.ntp.org");
-    //sntp_init();
-    display_show_text("Getting time...");
-
-//    int retry = 0;
-//    const int retry_count = 10;
-//    while (sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET && ++retry < retry_count) {
-//        ESP_LOGI(TAG, "Waiting for system time to be set... (%d/%d)", retry, retry_count);
-//        vTaskDelay(2000 / portTICK_PERIOD_MS);
-//    }
-    
-    ESP_LOGI(TAG, "WiFi Connected!");
-    display_show_text("WiFi Connected!");
-
-    camera_init();
-    server_comm_init();
-    ai_processor_init();
-
-    display_show_text("Ready!");
-
-    // Start main processing task
-    xTaskCreate(ai_processing_task, "ai_task", 8192, NULL, 5, NULL);
-
-    ESP_LOGI(TAG, "A-EYE Initialized Successfully");
+    ESP_ERROR_CHECK(boot_manager_run(boot_steps, sizeof(boot_steps) / sizeof(boot_steps[0])));
 }
\ No newline at end of file
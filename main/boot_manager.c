@@ -0,0 +1,138 @@
+#include "boot_manager.h"
+#include "display_manager.h"
+#include "mem_budget.h"
+#include "config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+static const char *TAG = "BOOT_MANAGER";
+
+static const char* const stage_names[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_DISPLAY] = "display",
+    [BOOT_STAGE_WIFI] = "wifi",
+    [BOOT_STAGE_NETWORK] = "network",
+    [BOOT_STAGE_CAMERA] = "camera",
+    [BOOT_STAGE_SERVER] = "server",
+    [BOOT_STAGE_AI] = "ai",
+    [BOOT_STAGE_PREVIEW] = "preview",
+    [BOOT_STAGE_FIRST_RESULT] = "first_result",
+};
+
+// Boot timeline, in microseconds since esp_timer started (early app startup)
+typedef struct {
+    int64_t start_us;
+    int64_t done_us;
+    esp_err_t result;
+    bool has_step;      // Stages without a step (e.g. preview when disabled) are left out of the log
+} boot_timeline_entry_t;
+
+static EventGroupHandle_t boot_events = NULL;
+#if MEMORY_STATIC_BUDGET
+static StaticEventGroup_t boot_events_storage;
+#endif
+static boot_timeline_entry_t timeline[BOOT_STAGE_COUNT];
+
+static void boot_log_timeline(void) {
+    ESP_LOGI(TAG, "Boot timeline (ms since start):");
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        if (!timeline[i].has_step && timeline[i].done_us == 0) {
+            continue;
+        }
+        if (timeline[i].done_us == 0) {
+            ESP_LOGI(TAG, "  %-12s pending", stage_names[i]);
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-12s %6lld -> %6lld ms (%s)", stage_names[i],
+                 timeline[i].start_us / 1000, timeline[i].done_us / 1000,
+                 esp_err_to_name(timeline[i].result));
+    }
+    ESP_LOGI(TAG, "Time to first result: %lld ms", timeline[BOOT_STAGE_FIRST_RESULT].done_us / 1000);
+}
+
+// Steps are short-lived and free their stacks when done, so they stay on the heap
+static void boot_step_task(void* pvParameters) {
+    const boot_step_t* step = (const boot_step_t*)pvParameters;
+
+    if (step->depends_on) {
+        xEventGroupWaitBits(boot_events, step->depends_on, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    timeline[step->stage].start_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Step '%s' started", step->name);
+
+    esp_err_t err = step->init();
+    if (err != ESP_OK) {
+        // Dependents are still released, matching the previous best-effort serial boot
+        ESP_LOGE(TAG, "Step '%s' failed: %s", step->name, esp_err_to_name(err));
+    }
+    boot_mark(step->stage, err);
+
+    vTaskDelete(NULL);
+}
+
+esp_err_t boot_manager_run(const boot_step_t* steps, size_t count) {
+    if (!boot_events) {
+#if MEMORY_STATIC_BUDGET
+        boot_events = xEventGroupCreateStatic(&boot_events_storage);
+#else
+        boot_events = xEventGroupCreate();
+#endif
+        if (!boot_events) {
+            ESP_LOGE(TAG, "Failed to create boot event group");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    // Marked before any step runs, so the first result's log sees the full set
+    for (size_t i = 0; i < count; i++) {
+        timeline[steps[i].stage].has_step = true;
+    }
+    timeline[BOOT_STAGE_FIRST_RESULT].has_step = true;
+
+    for (size_t i = 0; i < count; i++) {
+        if (xTaskCreate(boot_step_task, steps[i].name, steps[i].stack_size,
+                        (void*)&steps[i], BOOT_TASK_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to start step '%s'", steps[i].name);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+void boot_mark(boot_stage_t stage, esp_err_t result) {
+    if (stage >= BOOT_STAGE_COUNT || !boot_events || timeline[stage].done_us != 0) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (timeline[stage].start_us == 0) {
+        timeline[stage].start_us = now;
+    }
+    timeline[stage].done_us = now;
+    timeline[stage].result = result;
+    xEventGroupSetBits(boot_events, BOOT_BIT(stage));
+
+    ESP_LOGI(TAG, "Stage '%s' done at %lld ms", stage_names[stage], now / 1000);
+    if (stage == BOOT_STAGE_FIRST_RESULT) {
+        // By now every long-lived task has run a full cycle, so high-water marks are meaningful
+        boot_log_timeline();
+        mem_budget_report();
+    }
+}
+
+bool boot_stage_done(boot_stage_t stage) {
+    if (!boot_events || stage >= BOOT_STAGE_COUNT) {
+        return false;
+    }
+    return (xEventGroupGetBits(boot_events) & BOOT_BIT(stage)) != 0;
+}
+
+void boot_show_status(const char* text) {
+    // Steps may finish before the display is up, the log still records them
+    if (boot_stage_done(BOOT_STAGE_DISPLAY)) {
+        display_show_text(text);
+    } else {
+        ESP_LOGI(TAG, "Status (no display yet): %s", text);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#include "camera_manager.h"
+
+// Kept out of camera_manager.c so it builds without the camera driver
+size_t camera_burst_select(const size_t* jpeg_lens, size_t count) {
+    // At a fixed JPEG quality, edges and texture cost bytes: motion blur, defocus
+    // and closed eyes all shrink the frame. Ties go to the newer frame.
+    size_t best = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (jpeg_lens[i] >= jpeg_lens[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
\ No newline at end of file
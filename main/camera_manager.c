@@ -3,6 +3,8 @@
 #include "esp_camera.h"
 #include "esp_log.h"
 #include "esp_psram.h"
+#include "esp_timer.h"
+#include "frame_share.h"
 
 static const char *TAG = "CAMERA_MANAGER";
 
@@ -34,12 +36,13 @@ esp_err_t camera_init(void) {
         .pin_sccb_scl = CAMERA_PIN_SIOC,
         .pin_pwdn = CAMERA_PIN_PWDN,
         .pin_reset = CAMERA_PIN_RESET,
-        .xclk_freq_hz = 10000000,
+        .xclk_freq_hz = CAMERA_XCLK_MHZ * 1000000,
         .pixel_format = PIXFORMAT_JPEG,
         .frame_size = CAMERA_FRAME_SIZE,
         .jpeg_quality = CAMERA_JPEG_QUALITY,
-        .fb_count = 2,
+        .fb_count = CAMERA_FB_COUNT,
         .fb_location = CAMERA_FB_IN_PSRAM, // Use PSRAM
+        .grab_mode = CAMERA_GRAB_LATEST,   // Never hand out a stale queued frame
     };
 
     ESP_LOGI(TAG, "Initializing camera with PSRAM support");
@@ -60,6 +63,13 @@ esp_err_t camera_init(void) {
     ESP_LOGI(TAG, "Test capture successful! Size: %d bytes", test_fb->len);
     esp_camera_fb_return(test_fb);
 
+    // Shared frames go back to the driver once the uploader and every viewer are done
+    err = frame_share_init(camera_return_frame);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Frame sharing init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
     ESP_LOGI(TAG, "Camera initialized successfully");
     return ESP_OK;
 }
@@ -77,4 +87,75 @@ void camera_return_frame(camera_fb_t* fb) {
     if (fb) {
         esp_camera_fb_return(fb);
     }
+}
+
+int64_t camera_frame_timestamp_us(const camera_fb_t* fb) {
+    // The driver stamps each frame with esp_timer time when it is captured
+    return (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+}
+
+static bool camera_set_xclk(sensor_t* sensor, int mhz) {
+    if (!sensor || !sensor->set_xclk) {
+        return false;
+    }
+    return sensor->set_xclk(sensor, LEDC_TIMER_0, mhz) == 0;
+}
+
+camera_fb_t* camera_capture_burst(size_t frames) {
+    if (frames == 0 || frames > BURST_FRAMES) {
+        frames = BURST_FRAMES;
+    }
+
+    // fb_count can't change without reinitializing the driver, so it is sized for
+    // bursts at init; only the sensor clock is raised for the duration
+    sensor_t* sensor = esp_camera_sensor_get();
+    bool boosted = camera_set_xclk(sensor, BURST_XCLK_MHZ);
+    if (!boosted) {
+        ESP_LOGW(TAG, "Sensor clock can't be raised, bursting at the normal frame rate");
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < BURST_SETTLE_FRAMES && boosted; i++) {
+        camera_return_frame(esp_camera_fb_get());
+    }
+
+    // Only the best frame so far is held, each new frame either replaces it or goes straight back
+    size_t lens[BURST_FRAMES];
+    size_t grabbed = 0;
+    size_t total_bytes = 0;
+    size_t best_index = 0;
+    camera_fb_t* best = NULL;
+
+    while (grabbed < frames) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            ESP_LOGE(TAG, "Burst capture failed after %u frames", (unsigned)grabbed);
+            break;
+        }
+        lens[grabbed] = fb->len;
+        total_bytes += fb->len;
+        if (camera_burst_select(lens, grabbed + 1) == grabbed) {
+            camera_return_frame(best);
+            best = fb;
+            best_index = grabbed;
+        } else {
+            camera_return_frame(fb);
+        }
+        grabbed++;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    if (boosted && !camera_set_xclk(sensor, CAMERA_XCLK_MHZ)) {
+        ESP_LOGE(TAG, "Failed to restore the sensor clock");
+    }
+
+    if (best) {
+        // Shipping every frame instead would cost total_bytes (plus base64) per upload
+        ESP_LOGI(TAG, "Burst: %u frames in %lld ms (%.1f fps), kept #%u at %u bytes, all frames %u bytes (%.1fx)",
+                 (unsigned)grabbed, elapsed_us / 1000,
+                 elapsed_us > 0 ? grabbed * 1000000.0f / elapsed_us : 0.0f,
+                 (unsigned)best_index, (unsigned)best->len, (unsigned)total_bytes,
+                 (float)total_bytes / best->len);
+    }
+    return best;
 }
\ No newline at end of file
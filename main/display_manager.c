@@ -3,16 +3,145 @@
 #include "bsp/esp32_s3_eye.h"
 #include "esp_log.h"
 #include "esp_camera.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "lvgl.h"
+#include "jpeg_decoder.h"
+#include "mem_budget.h"
 #include <string.h>
 
 static const char* TAG = "DISPLAY_MANAGER";
 static lv_obj_t* camera_canvas = NULL;
 static uint8_t* cam_buff = NULL;
 static size_t cam_buff_size = 0;
+#if MEMORY_STATIC_BUDGET
+_Static_assert(DISPLAY_CANVAS_BYTES >= CAMERA_FRAME_WIDTH * CAMERA_FRAME_HEIGHT * 2, "DISPLAY_CANVAS_BYTES too small for the camera frame");
+MEM_PSRAM_BUFFER(cam_buff_static, DISPLAY_CANVAS_BYTES);
+#endif
+
+// The camera frame is shown zoomed to the panel width, keeping its 4:3 aspect
+#define PREVIEW_ZOOM (LV_IMG_ZOOM_NONE * BSP_LCD_H_RES / CAMERA_FRAME_WIDTH)
+#define PREVIEW_W (CAMERA_FRAME_WIDTH * PREVIEW_ZOOM / LV_IMG_ZOOM_NONE)
+#define PREVIEW_H (CAMERA_FRAME_HEIGHT * PREVIEW_ZOOM / LV_IMG_ZOOM_NONE)
+_Static_assert(PREVIEW_H <= BSP_LCD_V_RES, "Camera preview taller than the panel");
+_Static_assert(OVERLAY_MAX_AGE_MS >= FRAME_MAX_AGE_MS + CAPTURE_INTERVAL_MAX_MS,
+               "Overlay would expire before the next frame replaces it in a stable scene");
+
+static lv_obj_t* status_label = NULL;
+
+// Detection overlay: a fixed pool of box objects layered over the camera preview.
+// Boxes are only moved/resized/hidden when their geometry changes, so LVGL
+// invalidates just the old and new box areas instead of the whole screen.
+typedef struct {
+    lv_obj_t* frame;
+    lv_obj_t* label;
+    bool visible;
+} overlay_slot_t;
+
+static overlay_slot_t overlay_slots[DISPLAY_MAX_BOXES];
+static bool overlay_ready = false;
+// Capture time of the frame in the canvas, boxes only belong to this frame
+static int64_t canvas_capture_us = 0;
+static lv_timer_t* overlay_timer = NULL;
+
+static bool overlay_hide_from(size_t first)
+{
+    bool changed = false;
+    for (size_t i = first; i < DISPLAY_MAX_BOXES; i++) {
+        if (overlay_slots[i].visible) {
+            lv_obj_add_flag(overlay_slots[i].frame, LV_OBJ_FLAG_HIDDEN);
+            overlay_slots[i].visible = false;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+static void overlay_expire_cb(lv_timer_t* timer)
+{
+    // Runs in the LVGL task, which already holds the display lock. A new frame clears
+    // the boxes anyway, this only catches captures stopping (Wi-Fi down, breaker open)
+    if (!overlay_ready || canvas_capture_us == 0) return;
+
+    int64_t age_ms = (esp_timer_get_time() - canvas_capture_us) / 1000;
+    if (age_ms > OVERLAY_MAX_AGE_MS && overlay_hide_from(0)) {
+        ESP_LOGD(TAG, "Overlay expired, frame on screen is %lld ms old", age_ms);
+    }
+}
+
+static void overlay_create_slots(void)
+{
+    if (overlay_ready) return;
+
+    for (int i = 0; i < DISPLAY_MAX_BOXES; i++) {
+        lv_obj_t* frame = lv_obj_create(lv_scr_act());
+        lv_obj_remove_style_all(frame);
+        lv_obj_set_style_bg_opa(frame, LV_OPA_TRANSP, 0);
+        lv_obj_set_style_border_width(frame, 2, 0);
+        lv_obj_set_style_border_color(frame, lv_color_hex(0x00FF00), 0);
+        lv_obj_set_style_border_opa(frame, LV_OPA_COVER, 0);
+        lv_obj_clear_flag(frame, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_add_flag(frame, LV_OBJ_FLAG_HIDDEN);
+
+        lv_obj_t* label = lv_label_create(frame);
+        lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
+        lv_label_set_text(label, "");
+        lv_obj_set_style_text_color(label, lv_color_hex(0x00FF00), 0);
+        lv_obj_align(label, LV_ALIGN_TOP_LEFT, 3, 2);
+
+        overlay_slots[i].frame = frame;
+        overlay_slots[i].label = label;
+        overlay_slots[i].visible = false;
+    }
+
+    if (!overlay_timer) {
+        overlay_timer = lv_timer_create(overlay_expire_cb, OVERLAY_EXPIRE_PERIOD_MS, NULL);
+    }
+    overlay_ready = true;
+}
+
+static void overlay_place_slot(overlay_slot_t* slot, const display_box_t* box)
+{
+    // Clamp the normalized box to the frame and map it to the preview's area on the panel
+    float x0 = box->x < 0.0f ? 0.0f : (box->x > 1.0f ? 1.0f : box->x);
+    float y0 = box->y < 0.0f ? 0.0f : (box->y > 1.0f ? 1.0f : box->y);
+    float x1 = x0 + box->w > 1.0f ? 1.0f : x0 + box->w;
+    float y1 = y0 + box->h > 1.0f ? 1.0f : y0 + box->h;
+
+    lv_coord_t x = (BSP_LCD_H_RES - PREVIEW_W) / 2 + (lv_coord_t)(x0 * PREVIEW_W);
+    lv_coord_t y = (BSP_LCD_V_RES - PREVIEW_H) / 2 + (lv_coord_t)(y0 * PREVIEW_H);
+    lv_coord_t w = (lv_coord_t)((x1 - x0) * PREVIEW_W);
+    lv_coord_t h = (lv_coord_t)((y1 - y0) * PREVIEW_H);
+    if (w < 4) w = 4;
+    if (h < 4) h = 4;
+
+    // Only touch properties that changed so LVGL only marks the affected areas dirty
+    if (lv_obj_get_x(slot->frame) != x || lv_obj_get_y(slot->frame) != y) {
+        lv_obj_set_pos(slot->frame, x, y);
+    }
+    if (lv_obj_get_width(slot->frame) != w || lv_obj_get_height(slot->frame) != h) {
+        lv_obj_set_size(slot->frame, w, h);
+    }
+    if (strcmp(lv_label_get_text(slot->label), box->label) != 0) {
+        lv_label_set_text(slot->label, box->label);
+    }
+    if (!slot->visible) {
+        lv_obj_clear_flag(slot->frame, LV_OBJ_FLAG_HIDDEN);
+        slot->visible = true;
+    }
+}
+
+static void display_forget_objects(void)
+{
+    // lv_obj_clean() deleted every child of the screen, drop our references
+    status_label = NULL;
+    camera_canvas = NULL;
+    overlay_ready = false;
+    canvas_capture_us = 0;
+    memset(overlay_slots, 0, sizeof(overlay_slots));
+}
 
 void display_init(void)
 {
@@ -38,16 +167,26 @@ void display_show_text(const char* text)
 {
     if (!text) return;
 
-    lv_obj_clean(lv_scr_act()); // Clear current screen
-    lv_obj_t* label = lv_label_create(lv_scr_act());
-    lv_label_set_text(label, text);
-    lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
+    // Init steps and the AI task update the screen from different tasks, a timeout of 0 waits for the lock
+    bsp_display_lock(0);
+
+    // Reuse a single label so the camera canvas and overlay survive text updates
+    if (!status_label) {
+        status_label = lv_label_create(lv_scr_act());
+        lv_obj_align(status_label, LV_ALIGN_CENTER, 0, 0);
+    }
+    lv_label_set_text(status_label, text);
+    bsp_display_unlock();
     ESP_LOGI(TAG, "Displayed text: %s", text);
 }
 
 void display_test_pattern(void)
 {
+    bsp_display_lock(0);
     lv_obj_clean(lv_scr_act());
+    display_forget_objects();
+    bsp_display_unlock();
+
     lv_color_t colors[] = {
         lv_color_hex(0xFF0000), // Red
         lv_color_hex(0x00FF00), // Green
@@ -57,8 +196,10 @@ void display_test_pattern(void)
     };
 
     for (int i = 0; i < 5; i++) {
+        bsp_display_lock(0);
         lv_obj_set_style_bg_color(lv_scr_act(), colors[i], 0);
         lv_obj_invalidate(lv_scr_act());
+        bsp_display_unlock();
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
@@ -70,32 +211,112 @@ void display_blink_status(void)
     gpio_set_level(LED_GPIO_NUM, 1);
 }
 
-void display_prepare_camera_canvas(void)
+// Called with the display lock held
+static bool display_prepare_camera_canvas(void)
 {
     // Allocate buffer only once
     if (!cam_buff) {
-        cam_buff_size = BSP_LCD_H_RES * BSP_LCD_V_RES * 2;
+        cam_buff_size = CAMERA_FRAME_WIDTH * CAMERA_FRAME_HEIGHT * 2;
+#if MEMORY_STATIC_BUDGET
+        cam_buff = cam_buff_static;
+#else
         cam_buff = heap_caps_malloc(cam_buff_size, MALLOC_CAP_SPIRAM);
-        assert(cam_buff);
+        if (!cam_buff) {
+            ESP_LOGE(TAG, "Failed to allocate %d byte camera canvas", (int)cam_buff_size);
+            return false;
+        }
+#endif
+        mem_budget_register("camera_canvas", cam_buff_size, MEM_REGION_PSRAM, MEMORY_STATIC_BUDGET);
     }
 
     // Create canvas only once
     if (!camera_canvas) {
         camera_canvas = lv_canvas_create(lv_scr_act());
-        lv_canvas_set_buffer(camera_canvas, cam_buff, BSP_LCD_H_RES, BSP_LCD_V_RES, LV_IMG_CF_TRUE_COLOR);
+        lv_canvas_set_buffer(camera_canvas, cam_buff, CAMERA_FRAME_WIDTH, CAMERA_FRAME_HEIGHT, LV_IMG_CF_TRUE_COLOR);
+        lv_img_set_zoom(camera_canvas, PREVIEW_ZOOM);
         lv_obj_center(camera_canvas);
+        lv_obj_move_background(camera_canvas); // Keep the overlay and labels on top
     }
+    return true;
 }
 
-void display_show_camera_frame(camera_fb_t* frame)
+void display_show_camera_frame(const camera_fb_t* frame, int64_t capture_us)
 {
-    if (!frame || !camera_canvas || !cam_buff) return;
+    if (!frame || frame->format != PIXFORMAT_JPEG) return;
 
-    memcpy(cam_buff, frame->buf, cam_buff_size);
+    if (frame->width != CAMERA_FRAME_WIDTH || frame->height != CAMERA_FRAME_HEIGHT) {
+        ESP_LOGW(TAG, "Frame is %dx%d, preview expects %dx%d", frame->width, frame->height,
+                 CAMERA_FRAME_WIDTH, CAMERA_FRAME_HEIGHT);
+        return;
+    }
 
-#if BSP_LCD_BIGENDIAN
-    lv_draw_sw_rgb565_swap(cam_buff, cam_buff_size);
-#endif
+    bsp_display_lock(0);
+    if (!display_prepare_camera_canvas()) {
+        bsp_display_unlock();
+        return;
+    }
+
+    // Decode straight into the canvas, LVGL can't render it meanwhile since we hold the lock
+    int64_t start = esp_timer_get_time();
+    esp_jpeg_image_cfg_t cfg = {
+        .indata = frame->buf,
+        .indata_size = frame->len,
+        .outbuf = cam_buff,
+        .outbuf_size = cam_buff_size,
+        .out_format = JPEG_IMAGE_FORMAT_RGB565,
+        .out_scale = JPEG_IMAGE_SCALE_0,
+        .flags = {
+            .swap_color_bytes = LV_COLOR_16_SWAP,
+        },
+    };
+    esp_jpeg_image_output_t info;
+    esp_err_t err = esp_jpeg_decode(&cfg, &info);
+    if (err == ESP_OK) {
+        // The boxes on screen belong to the frame just replaced, they come back with this frame's result
+        overlay_hide_from(0);
+        canvas_capture_us = capture_us;
+        lv_obj_invalidate(camera_canvas);
+    }
+    bsp_display_unlock();
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Preview decode failed: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGD(TAG, "Preview decoded in %lld us", esp_timer_get_time() - start);
+}
+
+bool display_overlay_update(const display_box_t* boxes, size_t count, int64_t capture_us)
+{
+    if (!boxes && count > 0) return false;
+
+    bsp_display_lock(0);
+    overlay_create_slots();
+
+    // Boxes of any other frame would sit on the wrong picture
+    if (capture_us != canvas_capture_us) {
+        ESP_LOGW(TAG, "Dropping overlay for a frame not on screen (%lld us from it)", capture_us - canvas_capture_us);
+        bsp_display_unlock();
+        return false;
+    }
+
+    int64_t age_ms = (esp_timer_get_time() - capture_us) / 1000;
+    if (age_ms > OVERLAY_MAX_AGE_MS) {
+        ESP_LOGW(TAG, "Dropping stale overlay (%lld ms old)", age_ms);
+        bsp_display_unlock();
+        return false;
+    }
+
+    if (count > DISPLAY_MAX_BOXES) {
+        count = DISPLAY_MAX_BOXES;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        overlay_place_slot(&overlay_slots[i], &boxes[i]);
+    }
+    overlay_hide_from(count);
 
-    lv_obj_invalidate(camera_canvas);
+    bsp_display_unlock();
+    ESP_LOGI(TAG, "Overlay updated: %d boxes (%lld ms after capture)", (int)count, age_ms);
+    return count > 0;
 }
\ No newline at end of file
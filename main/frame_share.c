@@ -0,0 +1,96 @@
+#include "frame_share.h"
+#include "config.h"
+#include "esp_log.h"
+#include "os_lock.h"
+#include <stdbool.h>
+
+static const char *TAG = "FRAME_SHARE";
+
+// One wrapper per driver frame buffer is enough, frames can't outnumber them
+static shared_frame_t pool[CAMERA_FB_COUNT];
+static bool pool_used[CAMERA_FB_COUNT];
+static shared_frame_t* latest = NULL;
+static uint32_t next_seq = 1;
+static frame_release_fn_t release_fn = NULL;
+static os_lock_t lock;
+
+esp_err_t frame_share_init(frame_release_fn_t release) {
+    if (!release) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!os_lock_init(&lock)) {
+        return ESP_ERR_NO_MEM;
+    }
+    release_fn = release;
+    return ESP_OK;
+}
+
+shared_frame_t* frame_share_wrap(camera_fb_t* fb) {
+    if (!fb || !lock.ready) {
+        return NULL;
+    }
+
+    shared_frame_t* frame = NULL;
+    os_lock_take(&lock);
+    for (int i = 0; i < CAMERA_FB_COUNT; i++) {
+        if (!pool_used[i]) {
+            pool_used[i] = true;
+            frame = &pool[i];
+            frame->fb = fb;
+            frame->seq = next_seq++;
+            atomic_store(&frame->refs, 1);
+            break;
+        }
+    }
+    os_lock_give(&lock);
+
+    if (!frame) {
+        ESP_LOGE(TAG, "No free frame wrapper, more frames in flight than CAMERA_FB_COUNT");
+    }
+    return frame;
+}
+
+void frame_share_publish(shared_frame_t* frame) {
+    if (!frame) {
+        return;
+    }
+
+    atomic_fetch_add(&frame->refs, 1);
+
+    os_lock_take(&lock);
+    shared_frame_t* previous = latest;
+    latest = frame;
+    os_lock_give(&lock);
+
+    frame_share_release(previous);
+}
+
+shared_frame_t* frame_share_acquire_latest(uint32_t newer_than_seq) {
+    shared_frame_t* frame = NULL;
+
+    os_lock_take(&lock);
+    if (latest && latest->seq > newer_than_seq) {
+        frame = latest;
+        atomic_fetch_add(&frame->refs, 1);
+    }
+    os_lock_give(&lock);
+
+    return frame;
+}
+
+void frame_share_release(shared_frame_t* frame) {
+    if (!frame) {
+        return;
+    }
+    if (atomic_fetch_sub(&frame->refs, 1) != 1) {
+        return;
+    }
+
+    // Last reference gone, hand the buffer back to the driver and recycle the wrapper
+    release_fn(frame->fb);
+
+    os_lock_take(&lock);
+    frame->fb = NULL;
+    pool_used[frame - pool] = false;
+    os_lock_give(&lock);
+}
\ No newline at end of file
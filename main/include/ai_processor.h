@@ -2,9 +2,14 @@
 #define AI_PROCESSOR_H
 
 #include "esp_err.h"
+#include "server_comm.h"
+#include <stdint.h>
 
 esp_err_t ai_processor_init(void);
-void process_server_response(const char* response);
+void process_server_response(const server_response_t* response, int64_t capture_us);
 void ai_processing_task(void* pvParameters);
 
+// Makes the next capture a burst and wakes the task for it, e.g. from a button handler
+void ai_processor_request_burst(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef BOOT_MANAGER_H
+#define BOOT_MANAGER_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    BOOT_STAGE_DISPLAY,
+    BOOT_STAGE_WIFI,
+    BOOT_STAGE_NETWORK,
+    BOOT_STAGE_CAMERA,
+    BOOT_STAGE_SERVER,
+    BOOT_STAGE_AI,
+    BOOT_STAGE_PREVIEW,
+    BOOT_STAGE_FIRST_RESULT,
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+#define BOOT_BIT(stage) ((EventBits_t)1 << (stage))
+
+// One init step, run in its own task once every stage in depends_on is done
+typedef struct {
+    const char* name;
+    boot_stage_t stage;
+    EventBits_t depends_on;
+    esp_err_t (*init)(void);
+    uint32_t stack_size;
+} boot_step_t;
+
+esp_err_t boot_manager_run(const boot_step_t* steps, size_t count);
+void boot_mark(boot_stage_t stage, esp_err_t result);
+bool boot_stage_done(boot_stage_t stage);
+void boot_show_status(const char* text);
+
+#endif
\ No newline at end of file
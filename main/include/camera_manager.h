@@ -3,9 +3,20 @@
 
 #include "esp_err.h"
 #include "esp_camera.h"
+#include <stddef.h>
+#include <stdint.h>
 
 esp_err_t camera_init(void);
 camera_fb_t* camera_capture_frame(void);
 void camera_return_frame(camera_fb_t* fb);
+int64_t camera_frame_timestamp_us(const camera_fb_t* fb);
+
+// Grabs up to BURST_FRAMES consecutive frames (0 for all) at BURST_XCLK_MHZ and
+// returns the sharpest one, the others are returned to the driver
+camera_fb_t* camera_capture_burst(size_t frames);
+
+// Index of the sharpest frame by JPEG size, ties go to the later frame, 0 for no frames.
+// Pure, no driver access (camera_burst.c).
+size_t camera_burst_select(const size_t* jpeg_lens, size_t count);
 
 #endif
\ No newline at end of file
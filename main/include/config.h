@@ -6,13 +6,80 @@
 #define WIFI_PASSWORD "xfuw1104"
 
 // Server Configuration
+#define DEVICE_ID "esp32_glasses_001"
 #define SERVER_URL "https://a-eye-n8jr.onrender.com/analyze"
-#define SERVER_TIMEOUT_MS 30000
+#define SERVER_HEALTH_URL "https://a-eye-n8jr.onrender.com/health"  // Used to pre-warm the TLS connection at boot
+#define SERVER_TIMEOUT_MS 30000        // Upper bound, each request is further limited by its frame deadline
+#define SERVER_RESPONSE_MSGPACK 1       // Request the compact MessagePack response, JSON stays the fallback
+#define SERVER_RESPONSE_BUF_SIZE 2048
+
+// Memory Budget Configuration
+#define MEMORY_STATIC_BUDGET 0          // Allocate long-lived tasks and buffers statically, checked at build time
+#define MEM_BUDGET_INTERNAL_CAPACITY (96 * 1024)    // Share of internal DRAM our static allocations may claim
+#define MEM_BUDGET_PSRAM_CAPACITY (2 * 1024 * 1024) // Share of PSRAM, the rest is left to the camera driver
+#define AI_TASK_STACK_SIZE 8192
+#define LED_TASK_STACK_SIZE 2048
+#define WIFI_MONITOR_STACK_SIZE 2048
+#define SERVER_UPLOAD_BUF_SIZE (32 * 1024)          // Request body (base64 JPEG + fields), PSRAM
+#define SERVER_HTTP_BUF_SIZE 1024                   // esp_http_client RX/TX buffers, internal
+#define DISPLAY_CANVAS_BYTES (CAMERA_FRAME_WIDTH * CAMERA_FRAME_HEIGHT * 2)  // RGB565 camera preview, PSRAM
+
+// Boot Configuration
+#define BOOT_TEST_PATTERN 0             // Run the 5 s display test pattern before anything else
+#define BOOT_TASK_PRIORITY 5
+
+// Result Limits
+#define AI_MAX_FACES 4
+#define AI_MAX_OBJECTS 8
+#define AI_NAME_MAX_LEN 24
+#define AI_CONTEXT_MAX_LEN 64
 
 // Camera Configuration
 #define CAMERA_FRAME_SIZE FRAMESIZE_QQVGA
+#define CAMERA_FRAME_WIDTH 160          // Must match CAMERA_FRAME_SIZE
+#define CAMERA_FRAME_HEIGHT 120
 #define CAMERA_JPEG_QUALITY 15
 #define CAPTURE_INTERVAL_MS 3000
+#define CAMERA_XCLK_MHZ 10
+#define CAMERA_FB_COUNT ((PREVIEW_ENABLED ? 2 + PREVIEW_MAX_VIEWERS : 2) + (BURST_ENABLED ? 1 : 0))  // Each viewer may hold one frame, a burst holds its best frame
+#define FRAME_MAX_AGE_MS 5000           // Results for frames older than this are discarded
+#define STATS_LOG_INTERVAL_FRAMES 10
+#define CAPTURE_INTERVAL_MAX_MS 9000    // Capture interval once the scene has been stable for a while
+
+// Burst Capture Configuration
+#define BURST_ENABLED 1                 // Occasionally grab several frames at a raised clock and send the sharpest
+#define BURST_FRAMES 4
+#define BURST_XCLK_MHZ 20               // Sensor clock during a burst, restored to CAMERA_XCLK_MHZ afterwards
+#define BURST_SETTLE_FRAMES 1           // Frames dropped after the clock change, they may be torn or misexposed
+#define BURST_EVERY_N_CAPTURES 10       // Periodic burst, 0 to only burst on request (button or server hint)
+
+// Result Tracker Configuration
+#define TRACKER_MAX_TRACKS 12
+#define TRACKER_DECAY 0.5f              // Score kept per result, the rest comes from the new confidence
+#define TRACKER_ENTER_SCORE 0.6f
+#define TRACKER_EXIT_SCORE 0.25f
+#define TRACKER_STABILITY_ALPHA 0.7f
+
+// Circuit Breaker Configuration
+#define BREAKER_FAILURE_THRESHOLD 3     // Consecutive failed/overdue requests before opening
+#define BREAKER_BACKOFF_MIN_MS 2000
+#define BREAKER_BACKOFF_MAX_MS 60000
+
+// MJPEG Preview Configuration
+#define PREVIEW_ENABLED 0               // Serve the AI path's frames at http://<device>:PREVIEW_PORT/stream
+#define PREVIEW_PORT 8080
+#define PREVIEW_MAX_VIEWERS 2
+#define PREVIEW_VIEWER_STACK_SIZE 4096
+#define PREVIEW_VIEWER_PRIORITY 4
+#define PREVIEW_POLL_MS 50
+
+// Detection Overlay Configuration
+#define DISPLAY_MAX_BOXES 8
+#define OVERLAY_HOLD_MS 2000            // Slack for the capture itself (bursts take longer) before boxes count as stale
+// The frame on screen is replaced after at most its deadline plus the longest capture interval,
+// boxes only expire when captures stop altogether
+#define OVERLAY_MAX_AGE_MS (FRAME_MAX_AGE_MS + CAPTURE_INTERVAL_MAX_MS + OVERLAY_HOLD_MS)
+#define OVERLAY_EXPIRE_PERIOD_MS 250
 
 // GPIO Configurattion
 #define LED_GPIO_NUM 3
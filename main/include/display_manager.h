@@ -2,10 +2,25 @@
 #define DISPLAY_MANAGER_H
 
 #include "esp_err.h"
+#include "esp_camera.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    float x, y, w, h;   // Normalized to the camera frame (0.0 - 1.0)
+    char label[24];
+} display_box_t;
 
 void display_init(void);
 void display_show_text(const char* text);
 void display_blink_status(void);
 void display_test_pattern(void);
 
+// Shows a JPEG frame in the preview and clears the boxes of the frame it replaces.
+// Boxes are only drawn for the frame on screen, identified by its capture time.
+void display_show_camera_frame(const camera_fb_t* frame, int64_t capture_us);
+// Returns true when boxes are now drawn
+bool display_overlay_update(const display_box_t* boxes, size_t count, int64_t capture_us);
+
 #endif
\ No newline at end of file
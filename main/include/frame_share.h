@@ -0,0 +1,32 @@
+#ifndef FRAME_SHARE_H
+#define FRAME_SHARE_H
+
+#include "esp_err.h"
+#include "esp_camera.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * Reference-counted sharing of camera frames between the upload path and preview
+ * viewers. The capturing task wraps each camera_fb_t, publishes it as the latest
+ * frame and drops its own reference when the upload is done; viewers take a
+ * reference to whatever is latest. The frame goes back to the driver through the
+ * release callback only when the last holder lets go, so nobody copies or
+ * re-captures, and a slow viewer never blocks the uploader: it just skips to the
+ * newest frame next time.
+ */
+typedef struct {
+    camera_fb_t* fb;
+    uint32_t seq;
+    atomic_int refs;
+} shared_frame_t;
+
+typedef void (*frame_release_fn_t)(camera_fb_t* fb);
+
+esp_err_t frame_share_init(frame_release_fn_t release);
+shared_frame_t* frame_share_wrap(camera_fb_t* fb);
+void frame_share_publish(shared_frame_t* frame);
+shared_frame_t* frame_share_acquire_latest(uint32_t newer_than_seq);
+void frame_share_release(shared_frame_t* frame);
+
+#endif
\ No newline at end of file
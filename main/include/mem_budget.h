@@ -0,0 +1,67 @@
+#ifndef MEM_BUDGET_H
+#define MEM_BUDGET_H
+
+#include "config.h"
+#include "esp_attr.h"
+#include "soc/soc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    MEM_REGION_INTERNAL,
+    MEM_REGION_PSRAM,
+} mem_region_t;
+
+// Storage for a long-lived task, only backed by static buffers in static budget mode
+typedef struct {
+    StackType_t* stack;
+    StaticTask_t* tcb;
+} mem_task_storage_t;
+
+#if MEMORY_STATIC_BUDGET
+
+#if !CONFIG_SPIRAM_ALLOW_BSS_SEG_EXT_MEM
+#error "MEMORY_STATIC_BUDGET places buffers in PSRAM .bss, enable CONFIG_SPIRAM_ALLOW_BSS_SEG_EXT_MEM"
+#endif
+
+// Stacks stay in internal RAM: task stacks in PSRAM are unsafe while flash cache is disabled
+#define MEM_TASK_STORAGE(var, size) \
+    static StackType_t var##_stack[size]; \
+    static StaticTask_t var##_tcb; \
+    static const mem_task_storage_t var = { var##_stack, &var##_tcb }
+
+#define MEM_PSRAM_BUFFER(var, size) EXT_RAM_BSS_ATTR static uint8_t var[size]
+
+// Everything placed statically, checked against the configured capacity at build time
+#define MEM_BUDGET_INTERNAL_USED (AI_TASK_STACK_SIZE + LED_TASK_STACK_SIZE + WIFI_MONITOR_STACK_SIZE + \
+                                  SERVER_RESPONSE_BUF_SIZE + 2 * SERVER_HTTP_BUF_SIZE)
+#define MEM_BUDGET_PSRAM_USED (SERVER_UPLOAD_BUF_SIZE + DISPLAY_CANVAS_BYTES)
+
+// The configured capacities themselves must fit the target
+_Static_assert(MEM_BUDGET_INTERNAL_CAPACITY <= SOC_DIRAM_DRAM_HIGH - SOC_DIRAM_DRAM_LOW,
+               "MEM_BUDGET_INTERNAL_CAPACITY exceeds the target's internal DRAM");
+#if CONFIG_SPIRAM_SIZE > 0
+_Static_assert(MEM_BUDGET_PSRAM_CAPACITY <= CONFIG_SPIRAM_SIZE,
+               "MEM_BUDGET_PSRAM_CAPACITY exceeds the configured PSRAM size");
+#endif
+
+_Static_assert(MEM_BUDGET_INTERNAL_USED <= MEM_BUDGET_INTERNAL_CAPACITY,
+               "Static internal RAM budget exceeds MEM_BUDGET_INTERNAL_CAPACITY");
+_Static_assert(MEM_BUDGET_PSRAM_USED <= MEM_BUDGET_PSRAM_CAPACITY,
+               "Static PSRAM budget exceeds MEM_BUDGET_PSRAM_CAPACITY");
+
+#else
+
+#define MEM_TASK_STORAGE(var, size) \
+    static const mem_task_storage_t var = { NULL, NULL }
+
+#endif
+
+TaskHandle_t mem_budget_create_task(TaskFunction_t fn, const char* name, uint32_t stack_size,
+                                    void* arg, UBaseType_t priority, const mem_task_storage_t* storage);
+void mem_budget_register(const char* name, size_t size, mem_region_t region, bool is_static);
+void mem_budget_report(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef OS_LOCK_H
+#define OS_LOCK_H
+
+#include <stdbool.h>
+
+/*
+ * Mutex for modules that are also built by the host tests: a FreeRTOS mutex on
+ * the device (static storage in static budget mode), pthreads under HOST_BUILD.
+ * Take blocks until the lock is free.
+ */
+#if HOST_BUILD
+
+#include <pthread.h>
+
+typedef struct {
+    pthread_mutex_t mutex;
+    bool ready;
+} os_lock_t;
+
+static inline bool os_lock_init(os_lock_t* lock) {
+    if (!lock->ready) {
+        lock->ready = pthread_mutex_init(&lock->mutex, NULL) == 0;
+    }
+    return lock->ready;
+}
+
+static inline void os_lock_take(os_lock_t* lock) {
+    pthread_mutex_lock(&lock->mutex);
+}
+
+static inline void os_lock_give(os_lock_t* lock) {
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+#else
+
+#include "config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+typedef struct {
+    SemaphoreHandle_t handle;
+#if MEMORY_STATIC_BUDGET
+    StaticSemaphore_t storage;
+#endif
+    bool ready;
+} os_lock_t;
+
+static inline bool os_lock_init(os_lock_t* lock) {
+    if (!lock->ready) {
+#if MEMORY_STATIC_BUDGET
+        lock->handle = xSemaphoreCreateMutexStatic(&lock->storage);
+#else
+        lock->handle = xSemaphoreCreateMutex();
+#endif
+        lock->ready = lock->handle != NULL;
+    }
+    return lock->ready;
+}
+
+static inline void os_lock_take(os_lock_t* lock) {
+    xSemaphoreTake(lock->handle, portMAX_DELAY);
+}
+
+static inline void os_lock_give(os_lock_t* lock) {
+    xSemaphoreGive(lock->handle);
+}
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,9 @@
+#ifndef PREVIEW_SERVER_H
+#define PREVIEW_SERVER_H
+
+#include "esp_err.h"
+
+esp_err_t preview_server_start(void);
+esp_err_t preview_server_stop(void);
+
+#endif
\ No newline at end of file
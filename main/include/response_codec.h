@@ -0,0 +1,48 @@
+#ifndef RESPONSE_CODEC_H
+#define RESPONSE_CODEC_H
+
+#include "esp_err.h"
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compact response schema (MessagePack, Content-Type: application/msgpack)
+ *
+ *   [ version, faces, unknown_faces, objects, context, cache_hit, burst ]
+ *
+ *   version        uint, RESPONSE_SCHEMA_VERSION
+ *   faces/objects  array of [ name(str), confidence(uint, per-mille), box ]
+ *   box            nil or [ x, y, w, h ] (uint, per-mille of the frame)
+ *   unknown_faces  uint
+ *   context        str or nil
+ *   cache_hit      bool, the server reused the result of a near-identical frame
+ *   burst          bool, the server asks for a burst capture next (optional)
+ *
+ * Trailing elements are ignored so the schema can grow without breaking older firmware.
+ */
+#define RESPONSE_SCHEMA_VERSION 1
+
+typedef struct {
+    char name[AI_NAME_MAX_LEN];
+    float confidence;
+    bool has_box;
+    float x, y, w, h;   // Normalized to the frame (0.0 - 1.0)
+} ai_detection_t;
+
+typedef struct {
+    ai_detection_t faces[AI_MAX_FACES];
+    size_t face_count;
+    int unknown_faces;
+    ai_detection_t objects[AI_MAX_OBJECTS];
+    size_t object_count;
+    bool has_context;
+    char context[AI_CONTEXT_MAX_LEN];
+    bool burst_requested;   // Server hint: the next capture should be a burst
+} ai_result_t;
+
+esp_err_t response_decode_json(const char* body, ai_result_t* out);
+esp_err_t response_decode_msgpack(const uint8_t* body, size_t len, ai_result_t* out);
+
+#endif
\ No newline at end of file
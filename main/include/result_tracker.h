@@ -0,0 +1,36 @@
+#ifndef RESULT_TRACKER_H
+#define RESULT_TRACKER_H
+
+#include "response_codec.h"
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    TRACK_FACE,
+    TRACK_UNKNOWN_FACE,
+    TRACK_OBJECT,
+} track_kind_t;
+
+// A face identity or object seen across results, with a decaying score
+typedef struct {
+    bool in_use;
+    bool active;            // Entered above TRACKER_ENTER_SCORE, leaves below TRACKER_EXIT_SCORE
+    track_kind_t kind;
+    char name[AI_NAME_MAX_LEN];
+    float score;
+    ai_detection_t last;    // Latest detection, for its confidence and box
+    bool seen;              // Present in the latest result
+} track_t;
+
+typedef struct {
+    track_t tracks[TRACKER_MAX_TRACKS];
+    char context[AI_CONTEXT_MAX_LEN];
+    float stability;        // 0.0 (scene changing every result) - 1.0 (nothing changed for a while)
+} result_tracker_t;
+
+void result_tracker_init(result_tracker_t* tracker);
+bool result_tracker_update(result_tracker_t* tracker, const ai_result_t* result);
+float result_tracker_stability(const result_tracker_t* tracker);
+
+#endif
\ No newline at end of file
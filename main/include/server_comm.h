@@ -3,9 +3,38 @@
 
 #include "esp_err.h"
 #include "esp_camera.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    SERVER_FORMAT_JSON,
+    SERVER_FORMAT_MSGPACK,
+} server_format_t;
+
+typedef struct {
+    const uint8_t* body;    // Owned by server_comm, valid until the next request
+    size_t len;
+    server_format_t format;
+} server_response_t;
+
+typedef struct {
+    uint32_t requests;
+    uint32_t expired_before_send;   // Frame already past its deadline when the upload would start
+    uint32_t deadline_aborts;       // Request timed out against the frame deadline
+    uint32_t stale_responses;       // Response arrived after the deadline and was discarded
+    uint32_t breaker_trips;
+    uint32_t breaker_skips;         // Captures skipped while the breaker was open
+    uint32_t rate_limited;          // Requests answered with 429/503 and a Retry-After hint
+    uint32_t rate_limit_skips;      // Captures skipped while honoring Retry-After
+} server_comm_stats_t;
 
 esp_err_t server_comm_init(void);
 esp_err_t server_comm_deinit(void);
-char* server_send_image(camera_fb_t* fb);
+esp_err_t server_comm_prewarm(void);
+bool server_comm_ready(void);
+esp_err_t server_send_image(camera_fb_t* fb, int64_t deadline_us, server_response_t* out);
+void server_comm_get_stats(server_comm_stats_t* out);
+void server_comm_log_stats(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "mem_budget.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "MEM_BUDGET";
+
+#define MEM_BUDGET_MAX_ENTRIES 16
+
+typedef struct {
+    const char* name;
+    size_t size;
+    mem_region_t region;
+    bool is_static;
+    TaskHandle_t task;      // Set for task stacks, used for the high-water mark
+} mem_budget_entry_t;
+
+static mem_budget_entry_t entries[MEM_BUDGET_MAX_ENTRIES];
+static size_t entry_count = 0;
+// Boot steps register from their own tasks, so appends can race
+static portMUX_TYPE entries_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Tasks owned by components, reported by name when they exist
+static const char* const external_tasks[] = { "taskLVGL", "tiT", "wifi", "sys_evt" };
+
+static void mem_budget_add(const char* name, size_t size, mem_region_t region, bool is_static, TaskHandle_t task) {
+    bool added = false;
+
+    taskENTER_CRITICAL(&entries_lock);
+    if (entry_count < MEM_BUDGET_MAX_ENTRIES) {
+        entries[entry_count] = (mem_budget_entry_t) {
+            .name = name,
+            .size = size,
+            .region = region,
+            .is_static = is_static,
+            .task = task,
+        };
+        entry_count++;
+        added = true;
+    }
+    taskEXIT_CRITICAL(&entries_lock);
+
+    if (!added) {
+        ESP_LOGW(TAG, "Budget table full, '%s' not tracked", name);
+    }
+}
+
+TaskHandle_t mem_budget_create_task(TaskFunction_t fn, const char* name, uint32_t stack_size,
+                                    void* arg, UBaseType_t priority, const mem_task_storage_t* storage) {
+    TaskHandle_t handle = NULL;
+    bool is_static = storage && storage->stack && storage->tcb;
+
+    if (is_static) {
+        handle = xTaskCreateStatic(fn, name, stack_size, arg, priority, storage->stack, storage->tcb);
+    } else if (xTaskCreate(fn, name, stack_size, arg, priority, &handle) != pdPASS) {
+        handle = NULL;
+    }
+
+    if (!handle) {
+        ESP_LOGE(TAG, "Failed to create task '%s' (%lu bytes)", name, (unsigned long)stack_size);
+        return NULL;
+    }
+    mem_budget_add(name, stack_size, MEM_REGION_INTERNAL, is_static, handle);
+    return handle;
+}
+
+void mem_budget_register(const char* name, size_t size, mem_region_t region, bool is_static) {
+    mem_budget_add(name, size, region, is_static, NULL);
+}
+
+void mem_budget_report(void) {
+    size_t totals[2] = {0};
+
+    // Entries are filled before the count moves, so everything below the snapshot is complete
+    taskENTER_CRITICAL(&entries_lock);
+    size_t count = entry_count;
+    taskEXIT_CRITICAL(&entries_lock);
+
+    ESP_LOGI(TAG, "Memory budget (%s mode):", MEMORY_STATIC_BUDGET ? "static" : "dynamic");
+    for (size_t i = 0; i < count; i++) {
+        const mem_budget_entry_t* e = &entries[i];
+        totals[e->region] += e->size;
+
+        if (e->task) {
+            ESP_LOGI(TAG, "  %-22s %7u B  %-8s %-7s stack high-water: %u B free", e->name, (unsigned)e->size,
+                     e->region == MEM_REGION_PSRAM ? "psram" : "internal", e->is_static ? "static" : "heap",
+                     (unsigned)uxTaskGetStackHighWaterMark(e->task));
+        } else {
+            ESP_LOGI(TAG, "  %-22s %7u B  %-8s %-7s", e->name, (unsigned)e->size,
+                     e->region == MEM_REGION_PSRAM ? "psram" : "internal", e->is_static ? "static" : "heap");
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(external_tasks) / sizeof(external_tasks[0]); i++) {
+        TaskHandle_t task = xTaskGetHandle(external_tasks[i]);
+        if (task) {
+            ESP_LOGI(TAG, "  %-22s (component) stack high-water: %u B free", external_tasks[i],
+                     (unsigned)uxTaskGetStackHighWaterMark(task));
+        }
+    }
+
+    ESP_LOGI(TAG, "Tracked: internal %u B / %u B budget, psram %u B / %u B budget",
+             (unsigned)totals[MEM_REGION_INTERNAL], (unsigned)MEM_BUDGET_INTERNAL_CAPACITY,
+             (unsigned)totals[MEM_REGION_PSRAM], (unsigned)MEM_BUDGET_PSRAM_CAPACITY);
+    ESP_LOGI(TAG, "Heap free: internal %u B (min %u B), psram %u B (min %u B)",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "preview_server.h"
+#include "frame_share.h"
+#include "config.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "PREVIEW_SERVER";
+
+#define PART_BOUNDARY "aeyeframe"
+static const char* STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
+static const char* STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
+static const char* STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+
+static httpd_handle_t server = NULL;
+static atomic_int viewer_count = 0;
+
+// Streams shared frames to one viewer, always jumping to the newest frame
+static void preview_viewer_task(void* pvParameters) {
+    httpd_req_t* req = (httpd_req_t*)pvParameters;
+    uint32_t last_seq = 0;
+    uint32_t sent = 0;
+    uint32_t dropped = 0;
+    char part[64];
+
+    httpd_resp_set_type(req, STREAM_CONTENT_TYPE);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    while (1) {
+        shared_frame_t* frame = frame_share_acquire_latest(last_seq);
+        if (!frame) {
+            vTaskDelay(pdMS_TO_TICKS(PREVIEW_POLL_MS));
+            continue;
+        }
+
+        // Frames published while we were busy sending are simply skipped
+        if (last_seq != 0 && frame->seq > last_seq + 1) {
+            dropped += frame->seq - last_seq - 1;
+        }
+        last_seq = frame->seq;
+
+        int part_len = snprintf(part, sizeof(part), STREAM_PART, (unsigned)frame->fb->len);
+        esp_err_t err = httpd_resp_send_chunk(req, STREAM_BOUNDARY, strlen(STREAM_BOUNDARY));
+        if (err == ESP_OK) {
+            err = httpd_resp_send_chunk(req, part, part_len);
+        }
+        if (err == ESP_OK) {
+            err = httpd_resp_send_chunk(req, (const char*)frame->fb->buf, frame->fb->len);
+        }
+        frame_share_release(frame);
+
+        if (err != ESP_OK) {
+            break;  // Viewer went away
+        }
+        sent++;
+    }
+
+    ESP_LOGI(TAG, "Viewer disconnected: %lu frames sent, %lu dropped",
+             (unsigned long)sent, (unsigned long)dropped);
+    httpd_req_async_handler_complete(req);
+    atomic_fetch_sub(&viewer_count, 1);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t stream_handler(httpd_req_t* req) {
+    if (atomic_fetch_add(&viewer_count, 1) >= PREVIEW_MAX_VIEWERS) {
+        atomic_fetch_sub(&viewer_count, 1);
+        ESP_LOGW(TAG, "Viewer limit (%d) reached", PREVIEW_MAX_VIEWERS);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_sendstr(req, "Too many viewers");
+    }
+
+    // Hand the request to a viewer task so the server task stays free for others
+    httpd_req_t* async_req = NULL;
+    esp_err_t err = httpd_req_async_handler_begin(req, &async_req);
+    if (err == ESP_OK && xTaskCreate(preview_viewer_task, "preview_viewer", PREVIEW_VIEWER_STACK_SIZE,
+                                     async_req, PREVIEW_VIEWER_PRIORITY, NULL) != pdPASS) {
+        httpd_req_async_handler_complete(async_req);
+        err = ESP_ERR_NO_MEM;
+    }
+    if (err != ESP_OK) {
+        atomic_fetch_sub(&viewer_count, 1);
+        ESP_LOGE(TAG, "Failed to start viewer: %s", esp_err_to_name(err));
+        return httpd_resp_send_500(req);
+    }
+
+    ESP_LOGI(TAG, "Viewer connected (%d/%d)", atomic_load(&viewer_count), PREVIEW_MAX_VIEWERS);
+    return ESP_OK;
+}
+
+esp_err_t preview_server_start(void) {
+    if (server) {
+        return ESP_OK;
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = PREVIEW_PORT;
+    config.ctrl_port = PREVIEW_PORT + 1;
+    config.lru_purge_enable = true;
+
+    esp_err_t err = httpd_start(&server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start preview server: %s", esp_err_to_name(err));
+        server = NULL;
+        return err;
+    }
+
+    httpd_uri_t stream_uri = {
+        .uri = "/stream",
+        .method = HTTP_GET,
+        .handler = stream_handler,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(server, &stream_uri);
+
+    ESP_LOGI(TAG, "MJPEG preview on port %d at /stream", PREVIEW_PORT);
+    return ESP_OK;
+}
+
+esp_err_t preview_server_stop(void) {
+    if (!server) {
+        return ESP_OK;
+    }
+    esp_err_t err = httpd_stop(server);
+    server = NULL;
+    return err;
+}
\ No newline at end of file
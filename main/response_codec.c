@@ -0,0 +1,335 @@
+#include "response_codec.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "RESPONSE_CODEC";
+
+#define MSGPACK_MAX_DEPTH 8
+
+// Read cursor over a MessagePack buffer, nothing is allocated while decoding
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+} mp_reader_t;
+
+static bool mp_take(mp_reader_t* r, size_t n, const uint8_t** out) {
+    if ((size_t)(r->end - r->p) < n) {
+        return false;
+    }
+    *out = r->p;
+    r->p += n;
+    return true;
+}
+
+static uint32_t mp_be(const uint8_t* b, size_t n) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < n; i++) {
+        v = (v << 8) | b[i];
+    }
+    return v;
+}
+
+static bool mp_read_uint(mp_reader_t* r, uint32_t* out) {
+    const uint8_t* b;
+    if (!mp_take(r, 1, &b)) return false;
+
+    uint8_t tag = b[0];
+    if (tag <= 0x7f) {
+        *out = tag;
+        return true;
+    }
+
+    size_t n;
+    switch (tag) {
+        case 0xcc: n = 1; break;
+        case 0xcd: n = 2; break;
+        case 0xce: n = 4; break;
+        default: return false;
+    }
+    if (!mp_take(r, n, &b)) return false;
+    *out = mp_be(b, n);
+    return true;
+}
+
+static bool mp_read_array(mp_reader_t* r, uint32_t* count) {
+    const uint8_t* b;
+    if (!mp_take(r, 1, &b)) return false;
+
+    uint8_t tag = b[0];
+    if ((tag & 0xf0) == 0x90) {
+        *count = tag & 0x0f;
+        return true;
+    }
+    if (tag == 0xdc) {
+        if (!mp_take(r, 2, &b)) return false;
+        *count = mp_be(b, 2);
+        return true;
+    }
+    return false;
+}
+
+static bool mp_read_bool(mp_reader_t* r, bool* out) {
+    const uint8_t* b;
+    if (!mp_take(r, 1, &b) || (b[0] != 0xc2 && b[0] != 0xc3)) return false;
+    *out = b[0] == 0xc3;
+    return true;
+}
+
+static bool mp_try_nil(mp_reader_t* r) {
+    if (r->p < r->end && *r->p == 0xc0) {
+        r->p++;
+        return true;
+    }
+    return false;
+}
+
+// Copies a string into dst, truncating to fit
+static bool mp_read_str(mp_reader_t* r, char* dst, size_t dst_size) {
+    const uint8_t* b;
+    if (!mp_take(r, 1, &b)) return false;
+
+    uint8_t tag = b[0];
+    uint32_t len;
+    if ((tag & 0xe0) == 0xa0) {
+        len = tag & 0x1f;
+    } else if (tag == 0xd9 || tag == 0xda) {
+        size_t n = tag == 0xd9 ? 1 : 2;
+        if (!mp_take(r, n, &b)) return false;
+        len = mp_be(b, n);
+    } else {
+        return false;
+    }
+
+    const uint8_t* s;
+    if (!mp_take(r, len, &s)) return false;
+
+    size_t copy = len < dst_size - 1 ? len : dst_size - 1;
+    memcpy(dst, s, copy);
+    dst[copy] = '\0';
+    return true;
+}
+
+// Skips any single value, used to ignore fields added by newer schema versions
+static bool mp_skip(mp_reader_t* r, int depth) {
+    if (depth > MSGPACK_MAX_DEPTH) return false;
+
+    const uint8_t* b;
+    if (!mp_take(r, 1, &b)) return false;
+
+    uint8_t tag = b[0];
+    uint32_t items = 0;
+    size_t n = 0;
+
+    if (tag <= 0x7f || tag >= 0xe0 || tag == 0xc0 || tag == 0xc2 || tag == 0xc3) {
+        return true;
+    } else if ((tag & 0xe0) == 0xa0) {
+        return mp_take(r, tag & 0x1f, &b);
+    } else if ((tag & 0xf0) == 0x90) {
+        items = tag & 0x0f;
+    } else if ((tag & 0xf0) == 0x80) {
+        items = (tag & 0x0f) * 2;
+    } else {
+        switch (tag) {
+            case 0xcc: case 0xd0: return mp_take(r, 1, &b);
+            case 0xcd: case 0xd1: return mp_take(r, 2, &b);
+            case 0xce: case 0xd2: case 0xca: return mp_take(r, 4, &b);
+            case 0xcf: case 0xd3: case 0xcb: return mp_take(r, 8, &b);
+            case 0xd9: case 0xc4: n = 1; break;
+            case 0xda: case 0xc5: n = 2; break;
+            case 0xdb: case 0xc6: n = 4; break;
+            case 0xdc: case 0xde:
+                if (!mp_take(r, 2, &b)) return false;
+                items = mp_be(b, 2) * (tag == 0xde ? 2 : 1);
+                break;
+            case 0xdd: case 0xdf:
+                if (!mp_take(r, 4, &b)) return false;
+                items = mp_be(b, 4) * (tag == 0xdf ? 2 : 1);
+                break;
+            default: return false;
+        }
+        if (n > 0) {
+            if (!mp_take(r, n, &b)) return false;
+            return mp_take(r, mp_be(b, n), &b);
+        }
+    }
+
+    for (uint32_t i = 0; i < items; i++) {
+        if (!mp_skip(r, depth + 1)) return false;
+    }
+    return true;
+}
+
+static bool mp_skip_rest(mp_reader_t* r, uint32_t remaining) {
+    for (uint32_t i = 0; i < remaining; i++) {
+        if (!mp_skip(r, 1)) return false;
+    }
+    return true;
+}
+
+static bool mp_read_detection(mp_reader_t* r, ai_detection_t* det) {
+    uint32_t fields;
+    if (!mp_read_array(r, &fields) || fields < 3) return false;
+
+    uint32_t confidence;
+    if (!mp_read_str(r, det->name, sizeof(det->name))) return false;
+    if (!mp_read_uint(r, &confidence)) return false;
+    det->confidence = confidence / 1000.0f;
+
+    det->has_box = false;
+    if (!mp_try_nil(r)) {
+        uint32_t coords;
+        uint32_t v[4];
+        if (!mp_read_array(r, &coords) || coords < 4) return false;
+        for (int i = 0; i < 4; i++) {
+            if (!mp_read_uint(r, &v[i])) return false;
+        }
+        if (!mp_skip_rest(r, coords - 4)) return false;
+        det->x = v[0] / 1000.0f;
+        det->y = v[1] / 1000.0f;
+        det->w = v[2] / 1000.0f;
+        det->h = v[3] / 1000.0f;
+        det->has_box = true;
+    }
+
+    return mp_skip_rest(r, fields - 3);
+}
+
+// Decodes up to max detections, skipping any extra ones
+static bool mp_read_detections(mp_reader_t* r, ai_detection_t* dets, size_t max, size_t* count) {
+    uint32_t n;
+    if (!mp_read_array(r, &n)) return false;
+
+    *count = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (*count < max) {
+            if (!mp_read_detection(r, &dets[*count])) return false;
+            (*count)++;
+        } else if (!mp_skip(r, 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t response_decode_msgpack(const uint8_t* body, size_t len, ai_result_t* out) {
+    if (!body || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+
+    mp_reader_t r = { .p = body, .end = body + len };
+    uint32_t fields;
+    uint32_t version;
+    uint32_t unknown;
+
+    if (!mp_read_array(&r, &fields) || fields < 5 || !mp_read_uint(&r, &version)) {
+        ESP_LOGE(TAG, "Malformed MessagePack header");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (version != RESPONSE_SCHEMA_VERSION) {
+        ESP_LOGE(TAG, "Unsupported schema version %u", (unsigned)version);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (!mp_read_detections(&r, out->faces, AI_MAX_FACES, &out->face_count) ||
+        !mp_read_uint(&r, &unknown) ||
+        !mp_read_detections(&r, out->objects, AI_MAX_OBJECTS, &out->object_count)) {
+        ESP_LOGE(TAG, "Malformed MessagePack body");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    out->unknown_faces = (int)unknown;
+
+    if (!mp_try_nil(&r)) {
+        if (!mp_read_str(&r, out->context, sizeof(out->context))) {
+            ESP_LOGE(TAG, "Malformed MessagePack context");
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        out->has_context = true;
+    }
+
+    // Optional trailing fields: cache_hit is informational, burst is a capture hint
+    if (fields >= 7 && (!mp_skip(&r, 1) || !mp_read_bool(&r, &out->burst_requested))) {
+        ESP_LOGE(TAG, "Malformed MessagePack burst hint");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    return ESP_OK;
+}
+
+static bool json_read_detection(const cJSON* item, ai_detection_t* det) {
+    cJSON *name = cJSON_GetObjectItem(item, "name");
+    cJSON *confidence = cJSON_GetObjectItem(item, "confidence");
+    if (!cJSON_IsString(name) || !cJSON_IsNumber(confidence)) {
+        return false;
+    }
+
+    snprintf(det->name, sizeof(det->name), "%s", name->valuestring);
+    det->confidence = (float)confidence->valuedouble;
+    det->has_box = false;
+
+    // Optional normalized "box": { x, y, w, h }
+    cJSON *box = cJSON_GetObjectItem(item, "box");
+    if (cJSON_IsObject(box)) {
+        cJSON *x = cJSON_GetObjectItem(box, "x");
+        cJSON *y = cJSON_GetObjectItem(box, "y");
+        cJSON *w = cJSON_GetObjectItem(box, "w");
+        cJSON *h = cJSON_GetObjectItem(box, "h");
+        if (cJSON_IsNumber(x) && cJSON_IsNumber(y) && cJSON_IsNumber(w) && cJSON_IsNumber(h)) {
+            det->x = (float)x->valuedouble;
+            det->y = (float)y->valuedouble;
+            det->w = (float)w->valuedouble;
+            det->h = (float)h->valuedouble;
+            det->has_box = true;
+        }
+    }
+    return true;
+}
+
+static void json_read_detections(const cJSON* array, ai_detection_t* dets, size_t max, size_t* count) {
+    *count = 0;
+    if (!cJSON_IsArray(array)) {
+        return;
+    }
+
+    const cJSON *item;
+    cJSON_ArrayForEach(item, array) {
+        if (*count >= max) break;
+        if (json_read_detection(item, &dets[*count])) {
+            (*count)++;
+        }
+    }
+}
+
+esp_err_t response_decode_json(const char* body, ai_result_t* out) {
+    if (!body || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+
+    cJSON *json = cJSON_Parse(body);
+    if (!json) {
+        ESP_LOGE(TAG, "Failed to parse JSON response");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    json_read_detections(cJSON_GetObjectItem(json, "recognized_faces"), out->faces, AI_MAX_FACES, &out->face_count);
+    json_read_detections(cJSON_GetObjectItem(json, "objects"), out->objects, AI_MAX_OBJECTS, &out->object_count);
+
+    cJSON *unknown_faces = cJSON_GetObjectItem(json, "unknown_faces");
+    if (cJSON_IsNumber(unknown_faces)) {
+        out->unknown_faces = unknown_faces->valueint;
+    }
+
+    cJSON *context = cJSON_GetObjectItem(json, "context");
+    if (cJSON_IsString(context)) {
+        snprintf(out->context, sizeof(out->context), "%s", context->valuestring);
+        out->has_context = true;
+    }
+
+    out->burst_requested = cJSON_IsTrue(cJSON_GetObjectItem(json, "burst"));
+
+    cJSON_Delete(json);
+    return ESP_OK;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "result_tracker.h"
+#include <stdio.h>
+#include <string.h>
+
+// Tracks below this score that are no longer active are forgotten
+#define TRACKER_FORGET_SCORE 0.05f
+
+void result_tracker_init(result_tracker_t* tracker) {
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+static track_t* tracker_find_or_add(result_tracker_t* tracker, track_kind_t kind, const char* name) {
+    track_t* free_slot = NULL;
+    track_t* weakest = NULL;
+
+    for (int i = 0; i < TRACKER_MAX_TRACKS; i++) {
+        track_t* track = &tracker->tracks[i];
+        if (!track->in_use) {
+            if (!free_slot) free_slot = track;
+            continue;
+        }
+        if (track->kind == kind && strcmp(track->name, name) == 0) {
+            return track;
+        }
+        if (!track->active && (!weakest || track->score < weakest->score)) {
+            weakest = track;
+        }
+    }
+
+    // Full table: evict the weakest inactive track, active ones are never dropped for a newcomer
+    track_t* track = free_slot ? free_slot : weakest;
+    if (!track) {
+        return NULL;
+    }
+    memset(track, 0, sizeof(*track));
+    track->in_use = true;
+    track->kind = kind;
+    snprintf(track->name, sizeof(track->name), "%s", name);
+    return track;
+}
+
+static void tracker_observe(result_tracker_t* tracker, track_kind_t kind, const ai_detection_t* det) {
+    track_t* track = tracker_find_or_add(tracker, kind, det->name);
+    if (!track) {
+        return;
+    }
+    // Exponential moving average: one confident sighting is not enough to enter,
+    // one missed or low-confidence result is not enough to leave
+    if (!track->seen) {
+        track->score += det->confidence * (1.0f - TRACKER_DECAY);
+        track->last = *det;
+        track->seen = true;
+    }
+}
+
+bool result_tracker_update(result_tracker_t* tracker, const ai_result_t* result) {
+    bool changed = false;
+
+    // Everything fades unless this result confirms it
+    for (int i = 0; i < TRACKER_MAX_TRACKS; i++) {
+        tracker->tracks[i].score *= TRACKER_DECAY;
+        tracker->tracks[i].seen = false;
+    }
+
+    for (size_t i = 0; i < result->face_count; i++) {
+        tracker_observe(tracker, TRACK_FACE, &result->faces[i]);
+    }
+    for (size_t i = 0; i < result->object_count; i++) {
+        tracker_observe(tracker, TRACK_OBJECT, &result->objects[i]);
+    }
+    if (result->unknown_faces > 0) {
+        ai_detection_t unknown = { .name = "Unknown person", .confidence = 1.0f };
+        tracker_observe(tracker, TRACK_UNKNOWN_FACE, &unknown);
+    }
+
+    // Hysteresis: a track enters above the enter score and only leaves below the lower exit score
+    for (int i = 0; i < TRACKER_MAX_TRACKS; i++) {
+        track_t* track = &tracker->tracks[i];
+        if (!track->in_use) continue;
+
+        if (!track->active && track->score >= TRACKER_ENTER_SCORE) {
+            track->active = true;
+            changed = true;
+        } else if (track->active && track->score < TRACKER_EXIT_SCORE) {
+            track->active = false;
+            changed = true;
+        }
+
+        if (!track->active && track->score < TRACKER_FORGET_SCORE) {
+            track->in_use = false;
+        }
+    }
+
+    // Context is a single description, an absent one keeps the current text
+    if (result->has_context && strcmp(result->context, tracker->context) != 0) {
+        snprintf(tracker->context, sizeof(tracker->context), "%s", result->context);
+        changed = true;
+    }
+
+    tracker->stability = tracker->stability * TRACKER_STABILITY_ALPHA +
+                         (changed ? 0.0f : 1.0f - TRACKER_STABILITY_ALPHA);
+    return changed;
+}
+
+float result_tracker_stability(const result_tracker_t* tracker) {
+    return tracker->stability;
+}
\ No newline at end of file
@@ -4,12 +4,101 @@
 #include "esp_crt_bundle.h"
 #include "esp_log.h"
 #include "esp_timer.h"
-#include "cJSON.h"
+#include "mem_budget.h"
 #include "mbedtls/base64.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 
 static const char *TAG = "SERVER_COMM";
 static esp_http_client_handle_t s_http_client = NULL; // Make it static global
 
+// Response body is read straight into here, no per-request allocation
+static uint8_t s_response_buf[SERVER_RESPONSE_BUF_SIZE];
+static size_t s_response_len = 0;
+static bool s_response_overflow = false;
+static server_format_t s_response_format = SERVER_FORMAT_JSON;
+static int32_t s_retry_after_ms = -1;
+
+// Server asked us to back off (429/503 with Retry-After), uploads resume after this time
+static int64_t s_retry_until_us = 0;
+
+#if MEMORY_STATIC_BUDGET
+MEM_PSRAM_BUFFER(s_upload_buf, SERVER_UPLOAD_BUF_SIZE);
+#endif
+
+// Circuit breaker: after repeated failed or overdue requests, stop uploading for a
+// backoff period instead of tying the device up with a slow server
+typedef enum {
+    BREAKER_CLOSED,
+    BREAKER_OPEN,
+    BREAKER_HALF_OPEN,
+} breaker_state_t;
+
+static breaker_state_t s_breaker_state = BREAKER_CLOSED;
+static int s_breaker_failures = 0;
+static uint32_t s_breaker_backoff_ms = BREAKER_BACKOFF_MIN_MS;
+static int64_t s_breaker_open_until_us = 0;
+static server_comm_stats_t s_stats = {0};
+
+static void breaker_record(bool success) {
+    if (success) {
+        if (s_breaker_state != BREAKER_CLOSED) {
+            ESP_LOGI(TAG, "Circuit breaker closed");
+        }
+        s_breaker_state = BREAKER_CLOSED;
+        s_breaker_failures = 0;
+        s_breaker_backoff_ms = BREAKER_BACKOFF_MIN_MS;
+        return;
+    }
+
+    s_breaker_failures++;
+    if (s_breaker_state == BREAKER_HALF_OPEN || s_breaker_failures >= BREAKER_FAILURE_THRESHOLD) {
+        // A failed probe doubles the backoff, a fresh trip starts from the minimum
+        if (s_breaker_state == BREAKER_HALF_OPEN) {
+            s_breaker_backoff_ms = s_breaker_backoff_ms * 2 > BREAKER_BACKOFF_MAX_MS ?
+                                   BREAKER_BACKOFF_MAX_MS : s_breaker_backoff_ms * 2;
+        }
+        s_breaker_state = BREAKER_OPEN;
+        s_breaker_open_until_us = esp_timer_get_time() + (int64_t)s_breaker_backoff_ms * 1000;
+        s_stats.breaker_trips++;
+        ESP_LOGW(TAG, "Circuit breaker open for %lu ms after %d failures",
+                 (unsigned long)s_breaker_backoff_ms, s_breaker_failures);
+    }
+}
+
+// No request reached the server, so a half-open probe proves nothing: go back to
+// open with the current backoff already served, and the next upload probes again
+static void breaker_cancel_probe(void) {
+    if (s_breaker_state == BREAKER_HALF_OPEN) {
+        s_breaker_state = BREAKER_OPEN;
+        s_breaker_open_until_us = esp_timer_get_time();
+    }
+}
+
+static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
+    switch (evt->event_id) {
+        case HTTP_EVENT_ON_HEADER:
+            if (strcasecmp(evt->header_key, "Content-Type") == 0 &&
+                strstr(evt->header_value, "msgpack") != NULL) {
+                s_response_format = SERVER_FORMAT_MSGPACK;
+            }
+            // Prefer the millisecond hint, fall back to the standard header in seconds
+            else if (strcasecmp(evt->header_key, "Retry-After-Ms") == 0) {
+                s_retry_after_ms = atoi(evt->header_value);
+            }
+            else if (strcasecmp(evt->header_key, "Retry-After") == 0 && s_retry_after_ms < 0) {
+                s_retry_after_ms = atoi(evt->header_value) * 1000;
+            }
+            break;
+
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
 esp_err_t server_comm_init(void) {
     ESP_LOGI(TAG, "Server communication initializing...");
     esp_http_client_config_t config = {
@@ -17,10 +106,12 @@ esp_err_t server_comm_init(void) {
         .method = HTTP_METHOD_POST, // Default method, can be overridden per request
         .transport_type = HTTP_TRANSPORT_OVER_SSL,
         .timeout_ms = SERVER_TIMEOUT_MS,
-        .event_handler = NULL,
+        .event_handler = http_event_handler,
         .crt_bundle_attach = esp_crt_bundle_attach,
         .skip_cert_common_name_check = false,
         .keep_alive_enable = true, // Enable HTTP Keep-Alive
+        .buffer_size = SERVER_HTTP_BUF_SIZE,
+        .buffer_size_tx = SERVER_HTTP_BUF_SIZE,
     };
 
     s_http_client = esp_http_client_init(&config);
@@ -28,6 +119,11 @@ esp_err_t server_comm_init(void) {
         ESP_LOGE(TAG, "Failed to initialize HTTP client");
         return ESP_FAIL;
     }
+    mem_budget_register("http_response_buf", sizeof(s_response_buf), MEM_REGION_INTERNAL, true);
+    mem_budget_register("http_client_buffers", 2 * SERVER_HTTP_BUF_SIZE, MEM_REGION_INTERNAL, false);
+#if MEMORY_STATIC_BUDGET
+    mem_budget_register("http_upload_buf", sizeof(s_upload_buf), MEM_REGION_PSRAM, true);
+#endif
     ESP_LOGI(TAG, "Server communication initialized successfully");
     return ESP_OK;
 }
@@ -45,93 +141,274 @@ esp_err_t server_comm_deinit(void) {
     return ESP_OK;
 }
 
-char* encode_image_base64(const uint8_t *image_data, size_t image_len) {
+esp_err_t server_comm_prewarm(void) {
+    if (s_http_client == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // A cheap request to the same host completes DNS and the TLS handshake now,
+    // keep-alive then lets the first /analyze upload reuse the connection
+    int64_t start = esp_timer_get_time();
+    esp_http_client_set_url(s_http_client, SERVER_HEALTH_URL);
+    esp_http_client_set_method(s_http_client, HTTP_METHOD_GET);
+    esp_http_client_set_timeout_ms(s_http_client, SERVER_TIMEOUT_MS);
+    s_response_len = 0;
+    s_response_overflow = false;
+
+    esp_err_t err = esp_http_client_perform(s_http_client);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Connection pre-warm failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Connection pre-warmed in %lld ms (status %d)",
+             (esp_timer_get_time() - start) / 1000, esp_http_client_get_status_code(s_http_client));
+    return ESP_OK;
+}
+
+bool server_comm_ready(void) {
+    if (esp_timer_get_time() < s_retry_until_us) {
+        s_stats.rate_limit_skips++;
+        return false;
+    }
+    if (s_breaker_state != BREAKER_OPEN) {
+        return true;
+    }
+    if (esp_timer_get_time() >= s_breaker_open_until_us) {
+        ESP_LOGI(TAG, "Circuit breaker half-open, probing server");
+        s_breaker_state = BREAKER_HALF_OPEN;
+        return true;
+    }
+    s_stats.breaker_skips++;
+    return false;
+}
+
+void server_comm_get_stats(server_comm_stats_t* out) {
+    if (out) {
+        *out = s_stats;
+    }
+}
+
+void server_comm_log_stats(void) {
+    ESP_LOGI(TAG, "Requests: %lu, expired before send: %lu, deadline aborts: %lu, stale responses: %lu, "
+             "breaker trips: %lu, breaker skips: %lu, rate limited: %lu, rate limit skips: %lu",
+             (unsigned long)s_stats.requests, (unsigned long)s_stats.expired_before_send,
+             (unsigned long)s_stats.deadline_aborts, (unsigned long)s_stats.stale_responses,
+             (unsigned long)s_stats.breaker_trips, (unsigned long)s_stats.breaker_skips,
+             (unsigned long)s_stats.rate_limited, (unsigned long)s_stats.rate_limit_skips);
+}
+
+// Writes {"image":"<base64>","timestamp":<ms>,"device_id":"<id>"} straight into buf,
+// so the image is encoded once and no intermediate strings or JSON tree are built
+static esp_err_t build_request_body(const camera_fb_t *fb, char *buf, size_t cap, size_t *out_len) {
+    int head = snprintf(buf, cap, "{\"image\":\"");
+    if (head < 0 || (size_t)head >= cap) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
     size_t encoded_len = 0;
-    mbedtls_base64_encode(NULL, 0, &encoded_len, image_data, image_len);
+    if (mbedtls_base64_encode((unsigned char*)buf + head, cap - head, &encoded_len,
+                              fb->buf, fb->len) != 0) {
+        ESP_LOGE(TAG, "Base64 encoding failed, body buffer too small");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t used = head + encoded_len;
+    int tail = snprintf(buf + used, cap - used, "\",\"timestamp\":%lld,\"device_id\":\"%s\"}",
+                        esp_timer_get_time() / 1000, DEVICE_ID);
+    if (tail < 0 || (size_t)tail >= cap - used) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *out_len = used + tail;
+    return ESP_OK;
+}
+
+// Applies what is left of the frame's budget, capped at SERVER_TIMEOUT_MS, to the next
+// blocking step of the request; false once nothing is left
+static bool request_budget_left(int64_t deadline_us) {
+    int64_t remaining_ms = (deadline_us - esp_timer_get_time()) / 1000;
+    if (remaining_ms <= 0) {
+        return false;
+    }
+    esp_http_client_set_timeout_ms(s_http_client,
+                                   (int)(remaining_ms < SERVER_TIMEOUT_MS ? remaining_ms : SERVER_TIMEOUT_MS));
+    return true;
+}
 
-    char* encoded_data = malloc(encoded_len + 1);
-    if (encoded_data == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate memory for base64 encoding");
-        return NULL;
+// Runs the request one step at a time (connect, write, headers, each read) so the frame
+// deadline bounds the whole exchange, not just each step. ESP_ERR_TIMEOUT means the
+// deadline ran out. A body that doesn't fit sets s_response_overflow and stops reading.
+static esp_err_t request_exchange(const char *body, size_t body_len, int64_t deadline_us) {
+    if (!request_budget_left(deadline_us)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = esp_http_client_open(s_http_client, body_len);
+    if (err != ESP_OK) {
+        return request_budget_left(deadline_us) ? err : ESP_ERR_TIMEOUT;
     }
 
-    if (mbedtls_base64_encode((unsigned char*)encoded_data, encoded_len, &encoded_len,
-                              image_data, image_len) != 0) {
-        ESP_LOGE(TAG, "Base64 encoding failed");
-        free(encoded_data);
-        return NULL;
+    size_t written = 0;
+    while (written < body_len) {
+        if (!request_budget_left(deadline_us)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        int n = esp_http_client_write(s_http_client, body + written, body_len - written);
+        if (n < 0) {
+            return request_budget_left(deadline_us) ? ESP_FAIL : ESP_ERR_TIMEOUT;
+        }
+        written += n;
     }
 
-    encoded_data[encoded_len] = '\0';
-    return encoded_data;
+    if (!request_budget_left(deadline_us)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    // Headers (format, Retry-After) reach http_event_handler from here
+    if (esp_http_client_fetch_headers(s_http_client) < 0 && !esp_http_client_is_chunked_response(s_http_client)) {
+        return request_budget_left(deadline_us) ? ESP_FAIL : ESP_ERR_TIMEOUT;
+    }
+
+    while (!esp_http_client_is_complete_data_received(s_http_client)) {
+        if (!request_budget_left(deadline_us)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        // Keep one byte for the terminator so JSON bodies can be parsed in place
+        size_t room = sizeof(s_response_buf) - 1 - s_response_len;
+        if (room == 0) {
+            s_response_overflow = true;
+            break;
+        }
+        int n = esp_http_client_read(s_http_client, (char*)s_response_buf + s_response_len, room);
+        if (n < 0) {
+            return request_budget_left(deadline_us) ? ESP_FAIL : ESP_ERR_TIMEOUT;
+        }
+        if (n == 0 && !esp_http_client_is_complete_data_received(s_http_client)) {
+            // Connection closed before the whole body arrived
+            return ESP_FAIL;
+        }
+        s_response_len += n;
+    }
+    return ESP_OK;
 }
 
-char* server_send_image(camera_fb_t *fb) {
-    if (!fb || !fb->buf || fb->len == 0) {
+esp_err_t server_send_image(camera_fb_t *fb, int64_t deadline_us, server_response_t *out) {
+    if (!fb || !fb->buf || fb->len == 0 || !out) {
         ESP_LOGE(TAG, "Invalid frame buffer");
-        return NULL;
+        return ESP_ERR_INVALID_ARG;
     }
     if (s_http_client == NULL) {
         ESP_LOGE(TAG, "HTTP client not initialized. Call server_comm_init() first.");
-        return NULL;
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (esp_timer_get_time() < s_retry_until_us) {
+        ESP_LOGW(TAG, "Server asked to retry later, not sending");
+        breaker_cancel_probe();
+        return ESP_ERR_INVALID_STATE;
     }
 
-    char* base64_image = encode_image_base64(fb->buf, fb->len);
-    if (!base64_image) {
-        ESP_LOGE(TAG, "Failed to encode image to base64");
-        return NULL;
+    int64_t remaining_ms = (deadline_us - esp_timer_get_time()) / 1000;
+    if (remaining_ms <= 0) {
+        ESP_LOGW(TAG, "Frame expired %lld ms ago, not sending", -remaining_ms);
+        s_stats.expired_before_send++;
+        breaker_cancel_probe();
+        return ESP_ERR_TIMEOUT;
     }
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddItemToObject(json, "image", cJSON_CreateString(base64_image));
-    cJSON_AddItemToObject(json, "timestamp", cJSON_CreateNumber(esp_timer_get_time() / 1000));
-    cJSON_AddItemToObject(json, "device_id", cJSON_CreateString("esp32_glasses_001"));
+#if MEMORY_STATIC_BUDGET
+    char *body = (char*)s_upload_buf;
+    size_t body_cap = sizeof(s_upload_buf);
+#else
+    size_t body_cap = 4 * ((fb->len + 2) / 3) + 128;
+    char *body = malloc(body_cap);
+    if (!body) {
+        ESP_LOGE(TAG, "Failed to allocate %d byte request body", (int)body_cap);
+        breaker_cancel_probe();
+        return ESP_ERR_NO_MEM;
+    }
+#endif
 
-    char *json_string = cJSON_Print(json);
-    if (!json_string) {
-        ESP_LOGE(TAG, "Failed to convert JSON to string");
-        cJSON_Delete(json);
-        free(base64_image);
-        return NULL;
+    size_t body_len = 0;
+    esp_err_t err = build_request_body(fb, body, body_cap, &body_len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to build request body (%d byte frame)", (int)fb->len);
+#if !MEMORY_STATIC_BUDGET
+        free(body);
+#endif
+        breaker_cancel_probe();
+        return err;
     }
 
     // Reset URL and method for the current request (if needed, though POST to same URL is default)
     esp_http_client_set_url(s_http_client, SERVER_URL);
     esp_http_client_set_method(s_http_client, HTTP_METHOD_POST);
     esp_http_client_set_header(s_http_client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(s_http_client, json_string, strlen(json_string));
+#if SERVER_RESPONSE_MSGPACK
+    esp_http_client_set_header(s_http_client, "Accept", "application/msgpack, application/json;q=0.5");
+#else
+    esp_http_client_set_header(s_http_client, "Accept", "application/json");
+#endif
 
-    esp_err_t err = esp_http_client_perform(s_http_client);
-    char* response_buffer = NULL;
+    s_response_len = 0;
+    s_response_overflow = false;
+    s_response_format = SERVER_FORMAT_JSON;
+    s_retry_after_ms = -1;
+    s_stats.requests++;
 
-    if (err == ESP_OK) {
+    err = request_exchange(body, body_len, deadline_us);
+    int64_t overdue_ms = (esp_timer_get_time() - deadline_us) / 1000;
+    // Keep-alive only survives a fully read response, anything half-finished reconnects next time
+    bool fully_read = err == ESP_OK && !s_response_overflow;
+
+    if (err == ESP_OK && overdue_ms > 0) {
+        // Completed, but describes a scene the wearer has already left
+        ESP_LOGW(TAG, "Response arrived %lld ms past the frame deadline, discarded", overdue_ms);
+        s_stats.stale_responses++;
+        err = ESP_ERR_TIMEOUT;
+    }
+    else if (err == ESP_OK) {
         int status = esp_http_client_get_status_code(s_http_client);
-        int content_length = esp_http_client_get_content_length(s_http_client);
-
-        ESP_LOGI(TAG, "HTTP Status: %d, Content-Length: %d", status, content_length);
-
-        if (status == 200 && content_length > 0) {
-            response_buffer = malloc(content_length + 1);
-            if (response_buffer) {
-                int read = esp_http_client_read(s_http_client, response_buffer, content_length);
-                if (read > 0) {
-                    response_buffer[read] = '\0';
-                }
-                else {
-                    free(response_buffer);
-                    response_buffer = NULL;
-                }
-            }
+
+        ESP_LOGI(TAG, "HTTP Status: %d, Body: %d bytes (%s)", status, (int)s_response_len,
+                 s_response_format == SERVER_FORMAT_MSGPACK ? "msgpack" : "json");
+
+        if ((status == 429 || status == 503) && s_retry_after_ms >= 0) {
+            // The server is healthy but busy, back off as told instead of tripping the breaker
+            ESP_LOGW(TAG, "Server busy (%d), retrying in %ld ms", status, (long)s_retry_after_ms);
+            s_retry_until_us = esp_timer_get_time() + (int64_t)s_retry_after_ms * 1000;
+            s_stats.rate_limited++;
+            err = ESP_ERR_NOT_FINISHED;
         }
+        else if (status != 200 || s_response_len == 0) {
+            err = ESP_ERR_INVALID_RESPONSE;
+        } else if (s_response_overflow) {
+            ESP_LOGE(TAG, "Response larger than %d bytes, dropped", SERVER_RESPONSE_BUF_SIZE);
+            err = ESP_ERR_INVALID_SIZE;
+        } else {
+            s_response_buf[s_response_len] = '\0';
+            out->body = s_response_buf;
+            out->len = s_response_len;
+            out->format = s_response_format;
+        }
+    }
+    else if (err == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "Request abandoned at the frame deadline");
+        s_stats.deadline_aborts++;
     }
     else {
         ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
     }
 
+    if (!fully_read) {
+        esp_http_client_close(s_http_client);
+    }
+    // A timely "busy" reply still shows the server is up: it closes a half-open breaker
+    // and resets the failure count, while Retry-After alone holds off the next upload
+    breaker_record(err == ESP_OK || err == ESP_ERR_NOT_FINISHED);
+
     // No cleanup of the client handle here, only data specific to this request
-    free(base64_image);
-    free(json_string);
-    cJSON_Delete(json);
+#if !MEMORY_STATIC_BUDGET
+    free(body);
+#endif
 
-    return response_buffer;
+    return err;
 }
\ No newline at end of file
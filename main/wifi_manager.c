@@ -8,6 +8,7 @@
 #include "esp_mac.h"
 #include "driver/gpio.h"
 #include "freertos/task.h"
+#include "mem_budget.h"
 
 static const char *TAG = "WIFI_MANAGER";
 static EventGroupHandle_t wifi_event_group;
@@ -20,6 +21,12 @@ static const int MAX_FULL_RETRIES = 3;
 static bool wifi_connected = false;
 static bool wifi_failed = false;
 
+MEM_TASK_STORAGE(led_task_storage, LED_TASK_STACK_SIZE);
+MEM_TASK_STORAGE(monitor_task_storage, WIFI_MONITOR_STACK_SIZE);
+#if MEMORY_STATIC_BUDGET
+static StaticEventGroup_t wifi_event_group_storage;
+#endif
+
 static void log_disconnect_reason(int reason) {
     switch (reason) {
         case WIFI_REASON_AUTH_EXPIRE: ESP_LOGW(TAG, "AUTH_EXPIRE"); break;
@@ -121,7 +128,11 @@ static void wifi_timeout_monitor_task(void *pvParameter) {
 
 esp_err_t wifi_init(void) {
     ESP_LOGI(TAG, "Initializing Wi-Fi...");
+#if MEMORY_STATIC_BUDGET
+    wifi_event_group = xEventGroupCreateStatic(&wifi_event_group_storage);
+#else
     wifi_event_group = xEventGroupCreate();
+#endif
 
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -150,8 +161,8 @@ esp_err_t wifi_init(void) {
     ESP_ERROR_CHECK(esp_wifi_start());
 
     // ✅ Start indicator and timeout tasks
-    xTaskCreate(&led_wifi_indicator_task, "led_wifi_indicator", 8192, NULL, 5, NULL);
-    xTaskCreate(&wifi_timeout_monitor_task, "wifi_timeout_monitor", 2048, NULL, 5, NULL);
+    mem_budget_create_task(&led_wifi_indicator_task, "led_wifi_indicator", LED_TASK_STACK_SIZE, NULL, 5, &led_task_storage);
+    mem_budget_create_task(&wifi_timeout_monitor_task, "wifi_timeout_monitor", WIFI_MONITOR_STACK_SIZE, NULL, 5, &monitor_task_storage);
 
     return ESP_OK;
 }
@@ -0,0 +1,72 @@
+// Decode time and payload size of the recorded responses, MessagePack vs cJSON.
+// Host timings only show the relative cost, the ESP32-S3 is much slower in absolute terms.
+//
+//   bench_response_codec [iterations]
+#include "response_codec.h"
+#include "test_util.h"
+#include <time.h>
+
+#define FIXTURE_COUNT 8
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    volatile size_t sink = 0;
+    size_t total_mp = 0, total_json = 0;
+    double total_mp_us = 0, total_json_us = 0;
+
+    printf("%-12s %10s %10s %7s %14s %14s\n", "fixture", "json B", "msgpack B", "ratio", "json us/op", "msgpack us/op");
+    for (int i = 0; i < FIXTURE_COUNT; i++) {
+        char path[512];
+        size_t mp_len = 0, json_len = 0;
+        snprintf(path, sizeof(path), "%s/response_%d.msgpack", FIXTURE_DIR, i);
+        uint8_t* mp = (uint8_t*)test_read_file(path, &mp_len);
+        snprintf(path, sizeof(path), "%s/response_%d.json", FIXTURE_DIR, i);
+        char* json = test_read_file(path, &json_len);
+        if (!mp || !json) {
+            fprintf(stderr, "Missing fixture response_%d\n", i);
+            return EXIT_FAILURE;
+        }
+
+        ai_result_t r;
+        double start = now_us();
+        for (int n = 0; n < iterations; n++) {
+            response_decode_msgpack(mp, mp_len, &r);
+            sink += r.face_count;
+        }
+        double mp_us = (now_us() - start) / iterations;
+
+        double json_us = 0;
+#if HOST_HAVE_CJSON
+        start = now_us();
+        for (int n = 0; n < iterations; n++) {
+            response_decode_json(json, &r);
+            sink += r.face_count;
+        }
+        json_us = (now_us() - start) / iterations;
+#endif
+
+        printf("response_%-3d %10zu %10zu %6.1fx %14.2f %14.2f\n", i, json_len, mp_len,
+               (double)json_len / mp_len, json_us, mp_us);
+        total_mp += mp_len;
+        total_json += json_len;
+        total_mp_us += mp_us;
+        total_json_us += json_us;
+        free(mp);
+        free(json);
+    }
+
+    printf("%-12s %10zu %10zu %6.1fx %14.2f %14.2f\n", "total", total_json, total_mp,
+           (double)total_json / total_mp, total_json_us, total_mp_us);
+#if !HOST_HAVE_CJSON
+    printf("cJSON not found (set IDF_PATH or install libcjson-dev), JSON decode times not measured\n");
+#endif
+    (void)sink;
+    (void)test_failures;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+// Regenerates the recorded /analyze responses used by the host codec tests and bench.
+//
+// Runs the mock backend with a seeded random source and writes each response the
+// way the server sends it: the JSON body and the compact MessagePack body.
+//
+//   node test/host/fixtures/generate.js
+
+const fs = require('fs');
+const path = require('path');
+
+process.env.MOCK_DELAY_MIN_MS = '0';
+process.env.MOCK_DELAY_MAX_MS = '0';
+
+// Deterministic Math.random, so regenerating gives the same fixtures
+let seed = 20251019;
+Math.random = () => {
+    seed = (seed * 1103515245 + 12345) % 2147483648;
+    return seed / 2147483648;
+};
+
+const mock = require('../../../app/backends/mock');
+const { encodeCompactResponse } = require('../../../app/msgpack');
+
+const FIXTURE_COUNT = 8;
+
+async function main() {
+    for (let i = 0; i < FIXTURE_COUNT; i++) {
+        const response = await mock.analyze(new Uint8Array(0), { device_id: 'esp32_glasses_001' });
+        response.timestamp = 1760000000000 + i * 3000;
+        response.processing_time = 400 + Math.round(Math.random() * 800);
+        response.cache_hit = i % 4 === 3;
+        response.burst = i % 3 === 2;
+
+        const name = `response_${i}`;
+        fs.writeFileSync(path.join(__dirname, `${name}.json`), JSON.stringify(response));
+        fs.writeFileSync(path.join(__dirname, `${name}.msgpack`), encodeCompactResponse(response));
+        console.log(`${name}: ${response.recognized_faces.length} faces, ${response.unknown_faces} unknown, ` +
+                    `${response.objects.length} objects, context ${response.context ? 'yes' : 'no'}`);
+    }
+}
+
+main();
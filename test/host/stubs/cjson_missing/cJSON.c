@@ -0,0 +1,11 @@
+#include "cJSON.h"
+#include <stddef.h>
+
+cJSON* cJSON_Parse(const char* value) { (void)value; return NULL; }
+cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string) { (void)object; (void)string; return NULL; }
+int cJSON_IsTrue(const cJSON* item) { (void)item; return 0; }
+int cJSON_IsNumber(const cJSON* item) { (void)item; return 0; }
+int cJSON_IsString(const cJSON* item) { (void)item; return 0; }
+int cJSON_IsArray(const cJSON* item) { (void)item; return 0; }
+int cJSON_IsObject(const cJSON* item) { (void)item; return 0; }
+void cJSON_Delete(cJSON* item) { (void)item; }
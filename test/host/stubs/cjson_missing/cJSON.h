@@ -0,0 +1,26 @@
+// Placeholder used when no cJSON is found (neither ESP-IDF's copy nor a system install).
+// Every parse fails; tests and the bench check HOST_HAVE_CJSON and skip the JSON path.
+#ifndef CJSON_MISSING_H
+#define CJSON_MISSING_H
+
+typedef struct cJSON {
+    struct cJSON* next;
+    struct cJSON* child;
+    char* valuestring;
+    int valueint;
+    double valuedouble;
+} cJSON;
+
+cJSON* cJSON_Parse(const char* value);
+cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string);
+int cJSON_IsTrue(const cJSON* item);
+int cJSON_IsNumber(const cJSON* item);
+int cJSON_IsString(const cJSON* item);
+int cJSON_IsArray(const cJSON* item);
+int cJSON_IsObject(const cJSON* item);
+void cJSON_Delete(cJSON* item);
+
+#define cJSON_ArrayForEach(element, array) \
+    for (element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+
+#endif
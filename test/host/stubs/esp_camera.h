@@ -0,0 +1,21 @@
+// Host stand-in for esp32-camera: just the frame buffer type the shared modules pass around
+#ifndef ESP_CAMERA_H
+#define ESP_CAMERA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    PIXFORMAT_RGB565,
+    PIXFORMAT_JPEG,
+} pixformat_t;
+
+typedef struct {
+    uint8_t* buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+} camera_fb_t;
+
+#endif
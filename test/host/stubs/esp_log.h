@@ -0,0 +1,20 @@
+// Host stand-in for ESP-IDF's esp_log.h: errors and warnings go to stderr when
+// HOST_TEST_LOG is set in the environment, everything else is dropped
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ESP_LOG_HOST(level, tag, format, ...) do { \
+    if (getenv("HOST_TEST_LOG")) fprintf(stderr, level " (%s) " format "\n", tag, ##__VA_ARGS__); \
+} while (0)
+#define ESP_LOG_HOST_OFF(tag, format, ...) do { if (0) fprintf(stderr, format, ##__VA_ARGS__); (void)tag; } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_HOST("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_HOST("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_HOST_OFF(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_HOST_OFF(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_HOST_OFF(tag, format, ##__VA_ARGS__)
+
+#endif
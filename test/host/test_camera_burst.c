@@ -0,0 +1,72 @@
+// Burst frame selection: largest JPEG wins, ties go to the newer frame, and the
+// streaming use in camera_capture_burst() keeps the same frame as a full pass.
+#include "camera_manager.h"
+#include "test_util.h"
+
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+#define BURST_FRAMES_MAX_TEST 8
+
+static void test_basic(void) {
+    const size_t one[] = { 4200 };
+    CHECK_EQ_INT(camera_burst_select(one, 1), 0);
+    CHECK_EQ_INT(camera_burst_select(one, 0), 0);
+
+    const size_t sharpest_first[] = { 5100, 4800, 3900, 4000 };
+    CHECK_EQ_INT(camera_burst_select(sharpest_first, ARRAY_LEN(sharpest_first)), 0);
+
+    const size_t sharpest_middle[] = { 3900, 4000, 5100, 4800 };
+    CHECK_EQ_INT(camera_burst_select(sharpest_middle, ARRAY_LEN(sharpest_middle)), 2);
+
+    // Only the first count frames are looked at
+    CHECK_EQ_INT(camera_burst_select(sharpest_middle, 2), 1);
+}
+
+static void test_ties(void) {
+    const size_t all_equal[] = { 4000, 4000, 4000, 4000 };
+    CHECK_EQ_INT(camera_burst_select(all_equal, ARRAY_LEN(all_equal)), 3);
+
+    const size_t tie_for_best[] = { 3000, 4500, 4500, 4100 };
+    CHECK_EQ_INT(camera_burst_select(tie_for_best, ARRAY_LEN(tie_for_best)), 2);
+
+    const size_t tie_below_best[] = { 4500, 3000, 3000 };
+    CHECK_EQ_INT(camera_burst_select(tie_below_best, ARRAY_LEN(tie_below_best)), 0);
+}
+
+// camera_capture_burst() only holds the best frame so far: after each grab it asks
+// whether the newest frame wins among everything grabbed, and keeps it if so
+static size_t streaming_select(const size_t* lens, size_t count) {
+    size_t best = 0;
+    for (size_t grabbed = 1; grabbed < count; grabbed++) {
+        if (camera_burst_select(lens, grabbed + 1) == grabbed) {
+            best = grabbed;
+        }
+    }
+    return best;
+}
+
+static void test_streaming_matches_full_pass(void) {
+    uint32_t seed = 0x5eed;
+    for (int round = 0; round < 2000; round++) {
+        size_t lens[BURST_FRAMES_MAX_TEST];
+        size_t count = 1 + round % BURST_FRAMES_MAX_TEST;
+        // Narrow size ranges on some rounds so ties are common
+        uint32_t range = round % 3 == 0 ? 3 : 2000;
+        for (size_t i = 0; i < count; i++) {
+            seed = seed * 1103515245u + 12345u;
+            lens[i] = 3000 + (seed >> 16) % range;
+        }
+        size_t full = camera_burst_select(lens, count);
+        size_t streamed = streaming_select(lens, count);
+        if (full != streamed) {
+            fprintf(stderr, "round %d: streaming kept frame %zu, full pass picks %zu\n", round, streamed, full);
+            test_failures++;
+        }
+    }
+}
+
+int main(void) {
+    test_basic();
+    test_ties();
+    test_streaming_matches_full_pass();
+    TEST_DONE();
+}
@@ -0,0 +1,166 @@
+// Frame sharing: publish and acquire-latest ordering, the driver gets each buffer back
+// exactly once after its last holder lets go, and wrappers are recycled.
+#include "frame_share.h"
+#include "config.h"
+#include "test_util.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+#define MOCK_FRAMES 64
+
+// Mocked camera: frames come from a fixed array, returns are counted per frame
+static camera_fb_t mock_fbs[MOCK_FRAMES];
+static atomic_int returned[MOCK_FRAMES];
+static atomic_int return_order[MOCK_FRAMES];
+static atomic_int return_count;
+
+static void mock_return(camera_fb_t* fb) {
+    int i = (int)(fb - mock_fbs);
+    atomic_fetch_add(&returned[i], 1);
+    return_order[atomic_fetch_add(&return_count, 1) % MOCK_FRAMES] = i;
+}
+
+static void reset_returns(void) {
+    for (int i = 0; i < MOCK_FRAMES; i++) {
+        returned[i] = 0;
+    }
+    return_count = 0;
+}
+
+static void test_init(void) {
+    CHECK(frame_share_wrap(&mock_fbs[0]) == NULL);
+    CHECK_EQ_INT(frame_share_init(NULL), ESP_ERR_INVALID_ARG);
+    CHECK_EQ_INT(frame_share_init(mock_return), ESP_OK);
+    CHECK(frame_share_wrap(NULL) == NULL);
+    frame_share_publish(NULL);
+    frame_share_release(NULL);
+}
+
+static void test_publish_acquire_release(void) {
+    reset_returns();
+
+    // The capturer holds a frame that isn't published yet: viewers see nothing
+    shared_frame_t* first = frame_share_wrap(&mock_fbs[0]);
+    CHECK(first != NULL);
+    if (!first) {
+        return;
+    }
+    uint32_t first_seq = first->seq;
+    CHECK_EQ_INT(atomic_load(&first->refs), 1);
+    CHECK(frame_share_acquire_latest(0) == NULL);
+
+    // Published: the latest slot holds a reference, a viewer takes another
+    frame_share_publish(first);
+    CHECK_EQ_INT(atomic_load(&first->refs), 2);
+    shared_frame_t* viewed = frame_share_acquire_latest(0);
+    CHECK(viewed == first);
+    CHECK_EQ_INT(atomic_load(&first->refs), 3);
+
+    // A viewer that already has this frame gets nothing until a newer one is out
+    CHECK(frame_share_acquire_latest(first_seq) == NULL);
+
+    shared_frame_t* second = frame_share_wrap(&mock_fbs[1]);
+    CHECK(second != NULL && second->seq > first_seq);
+    frame_share_publish(second);
+    CHECK(frame_share_acquire_latest(first_seq) == second);
+    frame_share_release(second);
+
+    // Replacing the latest frame dropped its reference, the uploader and viewer still hold it
+    CHECK_EQ_INT(atomic_load(&first->refs), 2);
+    frame_share_release(first);
+    CHECK_EQ_INT(returned[0], 0);
+    frame_share_release(viewed);
+    CHECK_EQ_INT(returned[0], 1);
+    CHECK_EQ_INT(return_count, 1);
+
+    // Wrappers are recycled: the freed one is handed out again with a fresh sequence number
+    shared_frame_t* third = frame_share_wrap(&mock_fbs[2]);
+    CHECK(third == first);
+    CHECK(third && third->fb == &mock_fbs[2] && third->seq > second->seq);
+
+    // Uploader is done with both, only the latest slot keeps the newest one alive
+    frame_share_release(second);
+    CHECK_EQ_INT(returned[1], 0);
+    frame_share_publish(third);
+    CHECK_EQ_INT(returned[1], 1);
+    frame_share_release(third);
+    CHECK_EQ_INT(returned[2], 0);
+    CHECK_EQ_INT(return_order[0], 0);
+    CHECK_EQ_INT(return_order[1], 1);
+}
+
+static void test_pool_exhaustion(void) {
+    // One wrapper per driver buffer: the published frame holds one, the rest can be wrapped
+    shared_frame_t* held[CAMERA_FB_COUNT] = {0};
+    int wrapped = 0;
+    for (int i = 0; i < CAMERA_FB_COUNT; i++) {
+        held[i] = frame_share_wrap(&mock_fbs[10 + i]);
+        if (held[i]) {
+            wrapped++;
+        }
+    }
+    CHECK_EQ_INT(wrapped, CAMERA_FB_COUNT - 1);
+    CHECK(held[CAMERA_FB_COUNT - 1] == NULL);
+
+    for (int i = 0; i < CAMERA_FB_COUNT; i++) {
+        frame_share_release(held[i]);
+    }
+    for (int i = 0; i < CAMERA_FB_COUNT - 1; i++) {
+        CHECK_EQ_INT(returned[10 + i], 1);
+    }
+}
+
+// A viewer keeps grabbing the newest frame while the capturer publishes and releases
+static atomic_bool viewer_stop;
+
+static void* viewer_thread(void* arg) {
+    (void)arg;
+    uint32_t last_seq = 0;
+    while (!atomic_load(&viewer_stop)) {
+        shared_frame_t* frame = frame_share_acquire_latest(last_seq);
+        if (frame) {
+            CHECK(frame->seq > last_seq);
+            CHECK(frame->fb != NULL);
+            last_seq = frame->seq;
+            frame_share_release(frame);
+        }
+    }
+    return NULL;
+}
+
+static void test_concurrent_viewer(void) {
+    enum { ROUNDS = 20000 };
+    reset_returns();
+    int base_returns = 0;
+
+    pthread_t viewer;
+    atomic_store(&viewer_stop, false);
+    CHECK_EQ_INT(pthread_create(&viewer, NULL, viewer_thread, NULL), 0);
+
+    for (int i = 0; i < ROUNDS; i++) {
+        // Buffers 20..23 stand in for the driver's ring, reused as they come back
+        shared_frame_t* frame = frame_share_wrap(&mock_fbs[20 + i % 4]);
+        CHECK(frame != NULL);
+        frame_share_publish(frame);
+        frame_share_release(frame);
+    }
+    atomic_store(&viewer_stop, true);
+    pthread_join(viewer, NULL);
+
+    // Everything but the frame still in the latest slot went back exactly once,
+    // plus the frame the first publish replaced
+    for (int i = 20; i < 24; i++) {
+        base_returns += returned[i];
+    }
+    CHECK_EQ_INT(base_returns, ROUNDS - 1);
+    CHECK_EQ_INT(returned[2], 1);
+    CHECK_EQ_INT(return_count, ROUNDS);
+}
+
+int main(void) {
+    test_init();
+    test_publish_acquire_release();
+    test_pool_exhaustion();
+    test_concurrent_viewer();
+    TEST_DONE();
+}
@@ -0,0 +1,207 @@
+// Response codec: recorded responses decode the same through MessagePack and JSON,
+// and truncated or malformed MessagePack is rejected without reading past the buffer.
+#include "response_codec.h"
+#include "test_util.h"
+#include <string.h>
+
+#define FIXTURE_COUNT 8
+
+#if HOST_HAVE_CJSON
+static void check_same_detection(const ai_detection_t* a, const ai_detection_t* b) {
+    CHECK(strcmp(a->name, b->name) == 0);
+    CHECK_NEAR(a->confidence, b->confidence, 0.0011);
+    CHECK_EQ_INT(a->has_box, b->has_box);
+    if (a->has_box && b->has_box) {
+        CHECK_NEAR(a->x, b->x, 0.0011);
+        CHECK_NEAR(a->y, b->y, 0.0011);
+        CHECK_NEAR(a->w, b->w, 0.0011);
+        CHECK_NEAR(a->h, b->h, 0.0011);
+    }
+}
+#endif
+
+static void test_recorded_fixtures(void) {
+    for (int i = 0; i < FIXTURE_COUNT; i++) {
+        char path[512];
+        size_t mp_len = 0, json_len = 0;
+
+        snprintf(path, sizeof(path), "%s/response_%d.msgpack", FIXTURE_DIR, i);
+        uint8_t* mp = (uint8_t*)test_read_file(path, &mp_len);
+        snprintf(path, sizeof(path), "%s/response_%d.json", FIXTURE_DIR, i);
+        char* json = test_read_file(path, &json_len);
+        CHECK(mp != NULL && json != NULL);
+        if (!mp || !json) {
+            free(mp);
+            free(json);
+            continue;
+        }
+
+        ai_result_t from_mp;
+        CHECK_EQ_INT(response_decode_msgpack(mp, mp_len, &from_mp), ESP_OK);
+        CHECK(mp_len < json_len);
+
+        // Every shorter prefix is a truncated body and must be rejected
+        for (size_t n = 0; n < mp_len; n++) {
+            ai_result_t partial;
+            if (response_decode_msgpack(mp, n, &partial) == ESP_OK) {
+                fprintf(stderr, "response_%d: %zu of %zu bytes accepted\n", i, n, mp_len);
+                test_failures++;
+            }
+        }
+
+#if HOST_HAVE_CJSON
+        ai_result_t from_json;
+        CHECK_EQ_INT(response_decode_json(json, &from_json), ESP_OK);
+        CHECK_EQ_INT(from_mp.face_count, from_json.face_count);
+        CHECK_EQ_INT(from_mp.object_count, from_json.object_count);
+        CHECK_EQ_INT(from_mp.unknown_faces, from_json.unknown_faces);
+        CHECK_EQ_INT(from_mp.has_context, from_json.has_context);
+        CHECK(strcmp(from_mp.context, from_json.context) == 0);
+        CHECK_EQ_INT(from_mp.burst_requested, from_json.burst_requested);
+        for (size_t f = 0; f < from_mp.face_count && f < from_json.face_count; f++) {
+            check_same_detection(&from_mp.faces[f], &from_json.faces[f]);
+        }
+        for (size_t o = 0; o < from_mp.object_count && o < from_json.object_count; o++) {
+            check_same_detection(&from_mp.objects[o], &from_json.objects[o]);
+        }
+#endif
+        free(mp);
+        free(json);
+    }
+}
+
+static esp_err_t decode(const uint8_t* body, size_t len, ai_result_t* out) {
+    return response_decode_msgpack(body, len, out);
+}
+
+static void test_minimal_and_trailing_fields(void) {
+    ai_result_t r;
+
+    const uint8_t minimal[] = { 0x95, 0x01, 0x90, 0x00, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(minimal, sizeof(minimal), &r), ESP_OK);
+    CHECK_EQ_INT(r.face_count, 0);
+    CHECK_EQ_INT(r.object_count, 0);
+    CHECK_EQ_INT(r.has_context, false);
+    CHECK_EQ_INT(r.burst_requested, false);
+
+    // cache_hit, burst, then a map and a string from some future schema
+    const uint8_t extended[] = { 0x99, 0x01, 0x90, 0x02, 0x90, 0xa2, 'h', 'i', 0xc3, 0xc3,
+                                 0x81, 0xa1, 'k', 0x05, 0xa3, 'n', 'e', 'w' };
+    CHECK_EQ_INT(decode(extended, sizeof(extended), &r), ESP_OK);
+    CHECK_EQ_INT(r.unknown_faces, 2);
+    CHECK(strcmp(r.context, "hi") == 0);
+    CHECK_EQ_INT(r.burst_requested, true);
+
+    // Extra detection fields and box coordinates are skipped too
+    const uint8_t wide_detection[] = { 0x95, 0x01,
+                                       0x91, 0x94, 0xa1, 'A', 0xcd, 0x03, 0x84,
+                                       0x95, 0x0a, 0x14, 0x1e, 0x28, 0x32, 0xc2,
+                                       0x00, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(wide_detection, sizeof(wide_detection), &r), ESP_OK);
+    CHECK_EQ_INT(r.face_count, 1);
+    CHECK_NEAR(r.faces[0].confidence, 0.9, 0.0001);
+    CHECK_NEAR(r.faces[0].h, 0.04, 0.0001);
+}
+
+static void test_limits(void) {
+    ai_result_t r;
+
+    // Six faces: the first AI_MAX_FACES are kept, the rest skipped, the objects after still decode
+    uint8_t body[128];
+    size_t n = 0;
+    body[n++] = 0x95;
+    body[n++] = 0x01;
+    body[n++] = 0x96;
+    for (int i = 0; i < 6; i++) {
+        body[n++] = 0x93;
+        body[n++] = 0xa1;
+        body[n++] = (uint8_t)('A' + i);
+        body[n++] = 0x64;
+        body[n++] = 0xc0;
+    }
+    body[n++] = 0x00;
+    body[n++] = 0x91;
+    body[n++] = 0x93;
+    body[n++] = 0xa3;
+    body[n++] = 'p';
+    body[n++] = 'e';
+    body[n++] = 'n';
+    body[n++] = 0x64;
+    body[n++] = 0xc0;
+    body[n++] = 0xc0;
+    CHECK_EQ_INT(decode(body, n, &r), ESP_OK);
+    CHECK_EQ_INT(r.face_count, AI_MAX_FACES);
+    CHECK(strcmp(r.faces[AI_MAX_FACES - 1].name, "D") == 0);
+    CHECK_EQ_INT(r.object_count, 1);
+    CHECK(strcmp(r.objects[0].name, "pen") == 0);
+
+    // Names longer than the buffer are truncated, not overflowed
+    uint8_t long_name[64] = { 0x95, 0x01, 0x91, 0x93, 0xbe };
+    n = 5;
+    memset(long_name + n, 'x', 30);
+    n += 30;
+    long_name[n++] = 0x64;
+    long_name[n++] = 0xc0;
+    long_name[n++] = 0x00;
+    long_name[n++] = 0x90;
+    long_name[n++] = 0xc0;
+    CHECK_EQ_INT(decode(long_name, n, &r), ESP_OK);
+    CHECK_EQ_INT(strlen(r.faces[0].name), AI_NAME_MAX_LEN - 1);
+}
+
+static void test_malformed(void) {
+    ai_result_t r;
+
+    CHECK_EQ_INT(response_decode_msgpack(NULL, 0, &r), ESP_ERR_INVALID_ARG);
+
+    const uint8_t wrong_version[] = { 0x95, 0x02, 0x90, 0x00, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(wrong_version, sizeof(wrong_version), &r), ESP_ERR_NOT_SUPPORTED);
+
+    const uint8_t too_few_fields[] = { 0x94, 0x01, 0x90, 0x00, 0x90 };
+    CHECK_EQ_INT(decode(too_few_fields, sizeof(too_few_fields), &r), ESP_ERR_INVALID_RESPONSE);
+
+    const uint8_t map_not_array[] = { 0x81, 0xa1, 'v', 0x01 };
+    CHECK_EQ_INT(decode(map_not_array, sizeof(map_not_array), &r), ESP_ERR_INVALID_RESPONSE);
+
+    const uint8_t name_not_string[] = { 0x95, 0x01, 0x91, 0x93, 0x05, 0x64, 0xc0, 0x00, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(name_not_string, sizeof(name_not_string), &r), ESP_ERR_INVALID_RESPONSE);
+
+    const uint8_t short_detection[] = { 0x95, 0x01, 0x91, 0x92, 0xa1, 'A', 0x64, 0x00, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(short_detection, sizeof(short_detection), &r), ESP_ERR_INVALID_RESPONSE);
+
+    const uint8_t short_box[] = { 0x95, 0x01, 0x91, 0x93, 0xa1, 'A', 0x64, 0x93, 0x01, 0x02, 0x03,
+                                  0x00, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(short_box, sizeof(short_box), &r), ESP_ERR_INVALID_RESPONSE);
+
+    const uint8_t negative_count[] = { 0x95, 0x01, 0x90, 0xff, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(negative_count, sizeof(negative_count), &r), ESP_ERR_INVALID_RESPONSE);
+
+    const uint8_t burst_not_bool[] = { 0x97, 0x01, 0x90, 0x00, 0x90, 0xc0, 0xc2, 0x01 };
+    CHECK_EQ_INT(decode(burst_not_bool, sizeof(burst_not_bool), &r), ESP_ERR_INVALID_RESPONSE);
+
+    // A string claiming more bytes than the body holds
+    const uint8_t overlong_string[] = { 0x95, 0x01, 0x90, 0x00, 0x90, 0xd9, 0xc8, 'a', 'b' };
+    CHECK_EQ_INT(decode(overlong_string, sizeof(overlong_string), &r), ESP_ERR_INVALID_RESPONSE);
+
+    // Nesting deeper than the skipper allows, in the cache_hit slot that is skipped to reach burst
+    uint8_t deep[32] = { 0x97, 0x01, 0x90, 0x00, 0x90, 0xc0 };
+    size_t n = 6;
+    for (int i = 0; i < 20; i++) {
+        deep[n++] = 0x91;
+    }
+    deep[n++] = 0xc0;
+    deep[n++] = 0xc3;
+    CHECK_EQ_INT(decode(deep, n, &r), ESP_ERR_INVALID_RESPONSE);
+
+    // An array header claiming more elements than exist
+    const uint8_t huge_array[] = { 0x95, 0x01, 0xdc, 0xff, 0xff, 0x00, 0x90, 0xc0 };
+    CHECK_EQ_INT(decode(huge_array, sizeof(huge_array), &r), ESP_ERR_INVALID_RESPONSE);
+}
+
+int main(void) {
+    test_recorded_fixtures();
+    test_minimal_and_trailing_fields();
+    test_limits();
+    test_malformed();
+    TEST_DONE();
+}
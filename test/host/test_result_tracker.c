@@ -0,0 +1,146 @@
+// Result tracker: a recorded sequence of results for one object, checking when the
+// track enters and leaves, what update() reports as a change and the stability score.
+#include "result_tracker.h"
+#include "test_util.h"
+#include <string.h>
+
+// One step of the recorded sequence: confidence of "cup" in the result (0 = not detected)
+typedef struct {
+    float confidence;
+    bool active;        // Expected track state after the update
+    bool changed;       // Expected return of result_tracker_update()
+} step_t;
+
+static const step_t cup_sequence[] = {
+    { 0.9f, false, false },     // First sighting only raises the score to 0.45
+    { 0.9f, true,  true  },     // Second sighting enters (0.675)
+    { 0.9f, true,  false },     // 0.79
+    { 0.0f, true,  false },     // One miss is not enough to leave (0.39)
+    { 0.9f, true,  false },     // 0.65
+    { 0.3f, true,  false },     // One low-confidence dip neither (0.47)
+    { 0.9f, true,  false },     // 0.69
+    { 0.0f, true,  false },     // First miss (0.34)
+    { 0.0f, false, true  },     // Second miss in a row leaves (0.17)
+    { 0.0f, false, false },
+};
+
+static ai_result_t make_result(float cup_confidence) {
+    ai_result_t result = {0};
+    if (cup_confidence > 0.0f) {
+        snprintf(result.objects[0].name, sizeof(result.objects[0].name), "cup");
+        result.objects[0].confidence = cup_confidence;
+        result.object_count = 1;
+    }
+    return result;
+}
+
+static const track_t* find_track(const result_tracker_t* tracker, track_kind_t kind, const char* name) {
+    for (int i = 0; i < TRACKER_MAX_TRACKS; i++) {
+        const track_t* track = &tracker->tracks[i];
+        if (track->in_use && track->kind == kind && strcmp(track->name, name) == 0) {
+            return track;
+        }
+    }
+    return NULL;
+}
+
+static void test_enter_and_exit(void) {
+    result_tracker_t tracker;
+    result_tracker_init(&tracker);
+    CHECK_NEAR(result_tracker_stability(&tracker), 0.0, 1e-6);
+
+    float expected_stability = 0.0f;
+    for (size_t i = 0; i < sizeof(cup_sequence) / sizeof(cup_sequence[0]); i++) {
+        const step_t* step = &cup_sequence[i];
+        ai_result_t result = make_result(step->confidence);
+
+        bool changed = result_tracker_update(&tracker, &result);
+        const track_t* cup = find_track(&tracker, TRACK_OBJECT, "cup");
+
+        if (changed != step->changed) {
+            fprintf(stderr, "step %zu: changed %d, expected %d\n", i, changed, step->changed);
+            test_failures++;
+        }
+        if (!cup || cup->active != step->active) {
+            fprintf(stderr, "step %zu: cup track %s, expected %s\n", i,
+                    !cup ? "missing" : cup->active ? "active" : "inactive", step->active ? "active" : "inactive");
+            test_failures++;
+        }
+
+        // Stability moves towards 1 on unchanged results and drops on changes
+        expected_stability = expected_stability * TRACKER_STABILITY_ALPHA +
+                             (step->changed ? 0.0f : 1.0f - TRACKER_STABILITY_ALPHA);
+        CHECK_NEAR(result_tracker_stability(&tracker), expected_stability, 1e-5);
+    }
+
+    // The last detection is kept for its confidence and box
+    ai_result_t dip = make_result(0.3f);
+    result_tracker_update(&tracker, &dip);
+    const track_t* cup = find_track(&tracker, TRACK_OBJECT, "cup");
+    CHECK(cup && cup->seen);
+    CHECK(cup && fabsf(cup->last.confidence - 0.3f) < 1e-6f);
+
+    // A track that faded out is forgotten and its slot reused
+    ai_result_t empty = make_result(0.0f);
+    for (int i = 0; i < 4; i++) {
+        result_tracker_update(&tracker, &empty);
+    }
+    CHECK(find_track(&tracker, TRACK_OBJECT, "cup") == NULL);
+}
+
+static void test_stability_values(void) {
+    result_tracker_t tracker;
+    result_tracker_init(&tracker);
+    ai_result_t cup = make_result(0.9f);
+
+    result_tracker_update(&tracker, &cup);          // No change: 0.3
+    CHECK_NEAR(result_tracker_stability(&tracker), 0.3, 1e-5);
+    result_tracker_update(&tracker, &cup);          // Enter: 0.21
+    CHECK_NEAR(result_tracker_stability(&tracker), 0.21, 1e-5);
+    result_tracker_update(&tracker, &cup);          // 0.447
+    CHECK_NEAR(result_tracker_stability(&tracker), 0.447, 1e-5);
+
+    // A steady scene settles towards 1
+    for (int i = 0; i < 30; i++) {
+        result_tracker_update(&tracker, &cup);
+    }
+    CHECK(result_tracker_stability(&tracker) > 0.99f);
+}
+
+static void test_context_and_kinds(void) {
+    result_tracker_t tracker;
+    result_tracker_init(&tracker);
+
+    ai_result_t result = make_result(0.0f);
+    result.has_context = true;
+    snprintf(result.context, sizeof(result.context), "kitchen");
+    CHECK(result_tracker_update(&tracker, &result));
+    CHECK(strcmp(tracker.context, "kitchen") == 0);
+    CHECK(!result_tracker_update(&tracker, &result));
+
+    // An absent context keeps the current text
+    result.has_context = false;
+    CHECK(!result_tracker_update(&tracker, &result));
+    CHECK(strcmp(tracker.context, "kitchen") == 0);
+
+    // Faces, objects and unknown faces with the same name are separate tracks
+    ai_result_t mixed = {0};
+    snprintf(mixed.faces[0].name, sizeof(mixed.faces[0].name), "Unknown person");
+    mixed.faces[0].confidence = 1.0f;
+    mixed.face_count = 1;
+    mixed.unknown_faces = 2;
+    CHECK(!result_tracker_update(&tracker, &mixed));
+    CHECK(result_tracker_update(&tracker, &mixed));
+    const track_t* face = find_track(&tracker, TRACK_FACE, "Unknown person");
+    const track_t* unknown = find_track(&tracker, TRACK_UNKNOWN_FACE, "Unknown person");
+    CHECK(face && face->active);
+    CHECK(unknown && unknown->active);
+    CHECK(face != unknown);
+}
+
+int main(void) {
+    test_enter_and_exit();
+    test_stability_values();
+    test_context_and_kinds();
+    TEST_DONE();
+}
@@ -0,0 +1,66 @@
+// Minimal assertions for the host tests: failures are counted and reported, the test keeps going
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ_INT(actual, expected) do { \
+    long long a_ = (long long)(actual), e_ = (long long)(expected); \
+    if (a_ != e_) { \
+        fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) do { \
+    double a_ = (double)(actual), e_ = (double)(expected); \
+    if (fabs(a_ - e_) > (tolerance)) { \
+        fprintf(stderr, "%s:%d: %s == %f, expected %f\n", __FILE__, __LINE__, #actual, a_, e_); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define TEST_DONE() do { \
+    if (test_failures) { \
+        fprintf(stderr, "%d check(s) failed\n", test_failures); \
+        return EXIT_FAILURE; \
+    } \
+    printf("All checks passed\n"); \
+    return EXIT_SUCCESS; \
+} while (0)
+
+// Reads a whole file, NUL-terminated so JSON can be parsed in place; free() the result
+static inline char* test_read_file(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char* buf = malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    if (buf) {
+        buf[size] = '\0';
+        *len = (size_t)size;
+    }
+    return buf;
+}
+
+#endif